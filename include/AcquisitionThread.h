@@ -9,6 +9,7 @@
 #include <modbus/modbus.h>
 #include "ModbusData.h"
 #include "ConfigManager.h"
+#include "SpscRingBuffer.h"
 
 /**
  * Commandes de contrôle pour le thread d'acquisition
@@ -48,6 +49,7 @@ public:
     // Récupération des données
     bool hasData() const;
     ModbusData getData();
+    unsigned long long getOverflowCount() const { return dataQueue_.overflowCount(); }
     
     // État du thread
     bool isRunning() const { return running_; }
@@ -71,10 +73,8 @@ private:
     modbus_t* modbusContext_;
     bool connected_;
     
-    // File de données acquises
-    std::queue<ModbusData> dataQueue_;
-    mutable std::mutex dataMutex_;
-    std::condition_variable dataCondition_;
+    // File de données acquises (producteur: ce thread, consommateur: le publisher)
+    SpscRingBuffer<ModbusData> dataQueue_;
     
     // File de commandes de contrôle
     std::queue<AcquisitionControlMessage> controlQueue_;
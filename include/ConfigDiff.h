@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ConfigManager.h"
+
+/**
+ * Différence d'une ligne de production entre deux configurations.
+ * Une ligne désactivée est traitée comme absente: l'activer l'ajoute,
+ * la désactiver la retire.
+ */
+struct LineDiff {
+    std::string id;
+    ProductionLineConfig line;      // Nouvelle configuration (ancienne si la ligne est retirée)
+    bool added = false;
+    bool removed = false;
+    bool rateChanged = false;       // acquisitionFrequencyMs
+    bool registersChanged = false;  // Liste, ordre ou paramètres des registres
+    bool endpointChanged = false;   // Adresse IP, port ou unit id
+    bool tuningChanged = false;     // Ordonnancement du thread de collecte
+
+    /**
+     * Vrai si le collecteur doit être recréé (connexion ou thread modifiés)
+     */
+    bool requiresRestart() const { return endpointChanged || tuningChanged; }
+};
+
+/**
+ * Compare deux listes de lignes de production, identifiées par leur id.
+ * Seules les lignes modifiées sont retournées: retirées d'abord, puis les
+ * autres dans l'ordre de la nouvelle configuration.
+ */
+std::vector<LineDiff> diffProductionLines(const std::vector<ProductionLineConfig>& previous,
+                                          const std::vector<ProductionLineConfig>& current);
@@ -4,7 +4,11 @@
 #include <vector>
 #include <map>
 #include <yaml-cpp/yaml.h>
+#include <nlohmann/json.hpp>
 #include <mutex>
+#include <memory>
+#include <cstdint>
+#include "ThreadTuning.h"
 
 /**
  * Structure pour la configuration d'un registre Modbus
@@ -17,17 +21,48 @@ struct ModbusRegister {
     double offset = 0.0;
 };
 
+/**
+ * Liste de registres immuable, partagée par toutes les lignes d'un même profil
+ */
+using RegisterTable = std::vector<ModbusRegister>;
+
+/**
+ * Table vide partagée, valeur par défaut des registres
+ */
+inline const std::shared_ptr<const RegisterTable>& emptyRegisterTable() {
+    static const std::shared_ptr<const RegisterTable> table = std::make_shared<const RegisterTable>();
+    return table;
+}
+
+/**
+ * Profil d'équipement (section "device_profiles"): valeurs communes aux
+ * lignes qui le référencent, chacune pouvant les surcharger
+ */
+struct DeviceProfile {
+    std::string name;
+    int port = 502;
+    int unitId = 1;
+    int acquisitionFrequencyMs = 200;
+    int queueCapacity = 100;
+    std::shared_ptr<const RegisterTable> registers = emptyRegisterTable();
+    ThreadTuning threadTuning;
+};
+
 /**
  * Structure pour la configuration d'une ligne de production
  */
 struct ProductionLineConfig {
     std::string id;
     std::string ip;
+    std::string profile; // Profil d'équipement référencé, vide si aucun
     int port = 502;
     int unitId = 1;
     int acquisitionFrequencyMs = 200;
-    std::vector<ModbusRegister> registers;
+    int queueCapacity = 100; // Nombre d'échantillons en attente de publication
+    // Jamais nul; même table pour toutes les lignes d'un profil qui ne redéfinissent pas leurs registres
+    std::shared_ptr<const RegisterTable> registers = emptyRegisterTable();
     bool enabled = true;
+    ThreadTuning threadTuning; // Réglages du thread de collecte
 };
 
 /**
@@ -43,10 +78,63 @@ struct MqttConfig {
     std::string commandTopic = "supervision/commands";
     int publishFrequencyMs = 800;
     int qos = 1;
+    std::string publishMode = "latest"; // "latest" (dernier échantillon) ou "timeseries" (tous les échantillons)
+    
+    // Regroupement des trames par l'exporter MQTT (lingerMs = 0: une trame par message)
+    int lingerMs = 0;
+    int maxBatchBytes = 64 * 1024;
+    int maxInFlight = 64; // Publications non acquittées au maximum
+};
+
+/**
+ * Structure pour la configuration de l'ordonnancement des threads
+ */
+struct ThreadingConfig {
+    bool lockMemory = false;     // mlockall + pré-chargement des piles
+    ThreadTuning collectors;     // Valeurs par défaut des threads de collecte
+    ThreadTuning publisher;
+    ThreadTuning config;
+};
+
+/**
+ * Structure pour la configuration des logs
+ */
+struct LoggingConfig {
+    std::string level = "INFO";
+    std::string file = "supervision.log";
+    bool console = true;
+    bool async = false;             // Écriture par un thread dédié
+    int queueSize = 8192;           // Lignes en attente au plus (mode asynchrone)
+    std::string overflow = "drop";  // "drop" ou "block" lorsque la file est pleine
+    int rateLimitBurst = 5;         // Messages par site d'appel et par intervalle (0: pas de limite)
+    int rateLimitIntervalS = 60;
+};
+
+/**
+ * Configuration complète à un instant donné
+ *
+ * Immuable une fois publiée: un rechargement ou une modification publie un
+ * nouvel instantané, et ceux déjà distribués restent valides tant qu'ils sont
+ * référencés.
+ */
+struct ConfigSnapshot {
+    uint64_t version = 0; // Incrémentée à chaque publication
+    std::map<std::string, DeviceProfile> deviceProfiles;
+    std::vector<ProductionLineConfig> productionLines;
+    MqttConfig mqtt;
+    ThreadingConfig threading;
+    LoggingConfig logging;
+    nlohmann::json exporters = nlohmann::json::object();
+    
+    // Paramètres d'un exporter (section "exporters"), transmis tels quels à IExporter::configure
+    nlohmann::json getExporterConfig(const std::string& name) const;
 };
 
 /**
  * Gestionnaire de configuration
+ *
+ * Les lecteurs obtiennent l'instantané courant sans prendre configMutex_,
+ * qui ne sérialise que les écrivains (chargement et modifications).
  */
 class ConfigManager {
 public:
@@ -55,8 +143,17 @@ public:
     bool loadConfig(const std::string& configFile);
     bool reloadConfig();
     
-    const std::vector<ProductionLineConfig>& getProductionLines() const;
-    const MqttConfig& getMqttConfig() const;
+    /**
+     * Instantané courant, cohérent même si la configuration est rechargée pendant son utilisation
+     */
+    std::shared_ptr<const ConfigSnapshot> getSnapshot() const;
+    
+    // Copies tirées de l'instantané courant
+    std::vector<ProductionLineConfig> getProductionLines() const;
+    MqttConfig getMqttConfig() const;
+    ThreadingConfig getThreadingConfig() const;
+    LoggingConfig getLoggingConfig() const;
+    nlohmann::json getExporterConfig(const std::string& name) const;
     
     // Méthodes pour la reconfiguration dynamique
     bool updateLineConfig(const std::string& lineId, const ProductionLineConfig& newConfig);
@@ -69,15 +166,25 @@ public:
 
 private:
     std::string configFilePath_;
-    std::vector<ProductionLineConfig> productionLines_;
-    MqttConfig mqttConfig_;
-    mutable std::mutex configMutex_;
+    // Lu et remplacé uniquement par std::atomic_load / std::atomic_store
+    std::shared_ptr<const ConfigSnapshot> snapshot_;
+    std::mutex configMutex_;
     
     // Pour la surveillance des changements
     std::time_t lastModificationTime_;
     
-    void parseProductionLines(const YAML::Node& node);
-    void parseMqttConfig(const YAML::Node& node);
+    void publish(std::shared_ptr<ConfigSnapshot> snapshot);
+    template <typename Update>
+    bool updateLine(const std::string& lineId, Update&& update);
+    
+    void parseDeviceProfiles(const YAML::Node& node, ConfigSnapshot& config);
+    void parseProductionLines(const YAML::Node& node, ConfigSnapshot& config);
+    static std::shared_ptr<const RegisterTable> parseRegisters(const YAML::Node& node);
+    void parseMqttConfig(const YAML::Node& node, MqttConfig& mqtt);
+    void parseThreadingConfig(const YAML::Node& node, ThreadingConfig& threading);
+    void parseLoggingConfig(const YAML::Node& node, LoggingConfig& logging);
+    ThreadTuning parseThreadTuning(const YAML::Node& node, const ThreadTuning& defaults) const;
+    static nlohmann::json yamlToJson(const YAML::Node& node);
     std::time_t getFileModificationTime(const std::string& filepath) const;
 };
 
@@ -6,6 +6,7 @@
 #include <functional>
 #include <mqtt/async_client.h>
 #include "ConfigManager.h"
+#include "ThreadTuning.h"
 
 /**
  * Callback pour les commandes de reconfiguration
@@ -25,6 +26,9 @@ public:
     void stop();
     void join();
     
+    // Réglages d'ordonnancement appliqués au démarrage du thread
+    void setThreadTuning(const ThreadTuning& tuning) { threadTuning_ = tuning; }
+    
     // Callback pour les reconfigurations
     void setReconfigurationCallback(ReconfigurationCallback callback);
     
@@ -49,6 +53,7 @@ private:
     std::atomic<bool> running_;
     std::atomic<bool> stopRequested_;
     std::atomic<bool> connected_;
+    ThreadTuning threadTuning_;
     
     // Client MQTT
     std::unique_ptr<mqtt::async_client> mqttClient_;
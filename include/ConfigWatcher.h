@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <unordered_map>
+#include <sys/types.h>
+
+/**
+ * Surveillance du fichier de configuration
+ *
+ * Sous Linux, inotify surveille le répertoire du fichier plutôt que le fichier
+ * lui-même: les éditeurs qui écrivent une copie puis la renomment, et les
+ * remplacements de lien symbolique (ConfigMap Kubernetes), sont détectés.
+ * Les événements sont regroupés jusqu'à un silence de debounce, puis le
+ * fichier n'est signalé modifié que si son contenu a pu changer (inode,
+ * taille ou date de modification à la nanoseconde).
+ *
+ * Ailleurs, ou si inotify est indisponible, le fichier est vérifié chaque seconde.
+ */
+class ConfigWatcher {
+public:
+    explicit ConfigWatcher(std::chrono::milliseconds debounce = std::chrono::milliseconds(100));
+    ~ConfigWatcher();
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    /**
+     * Commence la surveillance de filepath.
+     * @return false si inotify est indisponible (vérification périodique)
+     */
+    bool start(const std::string& filepath);
+
+    /**
+     * Bloque jusqu'à une modification du fichier, ou jusqu'à wakeup().
+     * @return true si le fichier a été modifié
+     */
+    bool waitForChange();
+
+    /**
+     * Interrompt waitForChange(). Utilisable depuis un gestionnaire de signal.
+     */
+    void wakeup();
+
+private:
+    /**
+     * Identité et version du fichier suivi
+     */
+    struct Fingerprint {
+        bool exists = false;
+        dev_t device = 0;
+        ino_t inode = 0;
+        off_t size = 0;
+        int64_t mtimeNs = 0;
+
+        bool operator==(const Fingerprint& other) const;
+    };
+
+    Fingerprint readFingerprint() const;
+    void armWatches();
+    void watchEntry(const std::string& path);
+    bool readEvents();
+    bool checkChanged();
+
+    std::string filepath_;
+    std::chrono::milliseconds debounce_;
+    Fingerprint last_;
+    int inotifyFd_ = -1;
+    int wakePipe_[2] = {-1, -1};
+    // Descripteur de surveillance -> noms suivis dans ce répertoire
+    std::unordered_map<int, std::vector<std::string>> watchedNames_;
+};
@@ -1,9 +1,25 @@
 #pragma once
 
 #include <string>
-#include <fstream>
+#include <string_view>
+#include <charconv>
+#include <type_traits>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Niveau minimal compilé (0: DEBUG, 1: INFO, 2: WARN, 3: ERROR): les macros
+ * des niveaux inférieurs ne génèrent aucun code. Voir l'option CMake LOG_MIN_LEVEL.
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
 
 /**
  * Niveaux de log
@@ -15,42 +31,286 @@ enum class LogLevel {
     ERROR = 3
 };
 
+/**
+ * Comportement du mode asynchrone lorsque la file est pleine
+ */
+enum class LogOverflowPolicy {
+    DROP,   // Le message est abandonné et compté, le thread appelant n'attend jamais
+    BLOCK   // Le thread appelant attend qu'une place se libère
+};
+
+/**
+ * Site d'appel d'une macro LOG_*, clé de la limitation de débit
+ */
+struct LogSite {
+    const char* file;
+    int line;
+};
+
 /**
  * Classe singleton pour la gestion des logs
+ *
+ * En mode synchrone (défaut), chaque message est écrit par le thread appelant.
+ * En mode asynchrone, le thread appelant formate la ligne dans une file
+ * circulaire sans verrou; un thread dédié écrit les lignes par lots.
+ *
+ * Les macros LOG_* limitent le débit de chaque site d'appel, par contexte
+ * (l'identifiant du collecteur de thread courant): au-delà de burst messages
+ * par intervalle, les messages sont comptés puis résumés à la fin de l'intervalle.
  */
 class Logger {
 public:
     static Logger& getInstance();
-    
+
     void setLogLevel(LogLevel level);
+
+    /**
+     * Test du niveau sans appel de fonction: fait par les macros avant d'évaluer leurs arguments
+     */
+    static bool isEnabled(LogLevel level) {
+        return level >= currentLevel_.load(std::memory_order_relaxed);
+    }
+
     void setLogFile(const std::string& filename);
-    
+    void setConsoleOutput(bool enabled);
+
+    /**
+     * Active l'écriture asynchrone: capacity lignes en file au plus
+     * (arrondi à une puissance de deux), chacune tronquée à kRecordSize octets.
+     */
+    void enableAsync(size_t capacity, LogOverflowPolicy policy);
+
+    /**
+     * Attend que toutes les lignes en file soient écrites (sans effet en mode synchrone).
+     */
+    void flush();
+
+    /**
+     * Vide la file, arrête le thread d'écriture et repasse en mode synchrone.
+     */
+    void shutdown();
+
+    /**
+     * Installe des gestionnaires SIGSEGV, SIGBUS, SIGFPE, SIGILL et SIGABRT qui
+     * écrivent les lignes encore en file avant de laisser le signal terminer le processus.
+     */
+    void installCrashHandlers();
+
+    uint64_t getDroppedCount() const { return dropped_; }
+
+    /**
+     * Limite chaque site d'appel à burst messages par intervalle et par contexte (0: pas de limite).
+     */
+    void setRateLimit(uint32_t burst, std::chrono::seconds interval);
+    uint64_t getSuppressedCount() const { return suppressed_; }
+
+    /**
+     * Contexte du thread courant (identifiant du collecteur), distinguant ses
+     * messages de ceux des autres threads pour la limitation de débit.
+     */
+    static void setThreadContext(const std::string& context);
+    static const std::string& getThreadContext();
+
+    /**
+     * Écrit les résumés des messages supprimés dont l'intervalle est écoulé
+     * (tous si force). Appelée périodiquement par logAt() et le thread d'écriture.
+     */
+    void flushSuppressed(bool force = false);
+
+    /**
+     * Point d'entrée des macros: log() soumis à la limitation de débit du site.
+     * Sans verrou, une fois l'état du site enregistré pour le contexte du thread.
+     */
+    void logAt(const LogSite& site, LogLevel level, const std::string& message);
+
     void debug(const std::string& message);
     void info(const std::string& message);
     void warn(const std::string& message);
     void error(const std::string& message);
-    
+
     void log(LogLevel level, const std::string& message);
 
+    /**
+     * Formatage des macros: chaque "{}" du modèle est remplacé par l'argument
+     * suivant ("{{" et "}}" pour des accolades littérales). Un message seul
+     * est repris tel quel, accolades comprises.
+     */
+    static const std::string& format(const std::string& message) { return message; }
+    static std::string format(const char* message) { return message; }
+
+    template <typename... Args>
+    static std::string format(const char* pattern, const Args&... args) {
+        std::string out;
+        out.reserve(std::char_traits<char>::length(pattern) + 16 * sizeof...(Args));
+        const char* cursor = pattern;
+        ((appendLiteral(out, cursor) ? appendValue(out, args) : void()), ...);
+        while (appendLiteral(out, cursor)) {
+            out += "{}"; // Plus de "{}" que d'arguments
+        }
+        return out;
+    }
+
+    static constexpr size_t kRecordSize = 1024;
+
 private:
+    /**
+     * Site d'appel d'une macro et contexte du thread appelant
+     */
+    struct RateKey {
+        const LogSite* site;
+        std::string context;
+
+        bool operator==(const RateKey& other) const { return site == other.site && context == other.context; }
+    };
+
+    struct RateKeyHash {
+        size_t operator()(const RateKey& key) const {
+            return std::hash<const void*>()(key.site) ^ (std::hash<std::string>()(key.context) << 1);
+        }
+    };
+
+    /**
+     * État de la limitation de débit d'un site d'appel pour un contexte.
+     * Enregistré une fois sous rateMutex_, puis mis à jour sans verrou par
+     * les threads qui le gardent dans leur cache (rateCache_).
+     */
+    struct RateState {
+        const LogSite* site = nullptr;
+        std::string context;
+        std::atomic<int64_t> windowStartMs{0};      // steady_clock, en millisecondes
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint64_t> suppressed{0};
+        std::atomic<LogLevel> level{LogLevel::INFO}; // Niveau du dernier message supprimé
+        std::atomic<bool> retired{false};           // Retiré de rateStates_: les caches le remplacent
+    };
+
+    /**
+     * Résumé des messages supprimés, prêt à être écrit
+     */
+    struct Summary {
+        LogLevel level;
+        std::string message;
+    };
+
+    /**
+     * Ligne formatée en attente d'écriture (file de Vyukov, multi-producteurs)
+     */
+    struct Record {
+        std::atomic<size_t> sequence{0};
+        LogLevel level = LogLevel::INFO;
+        uint32_t length = 0;
+        char text[kRecordSize];
+    };
+
     Logger() = default;
-    ~Logger() = default;
+    ~Logger();
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
-    
+
     void writeLog(LogLevel level, const std::string& message);
-    std::string levelToString(LogLevel level) const;
-    std::string getCurrentTimestamp() const;
-    
-    LogLevel currentLevel_ = LogLevel::INFO;
-    std::unique_ptr<std::ofstream> logFile_;
+    RateState& rateStateFor(const LogSite& site, int64_t nowMs);
+    void sweepRateStates(int64_t nowMs);
+    // Appelée avec rateMutex_ verrouillé
+    std::vector<Summary> collectSummaries(int64_t nowMs, bool force);
+    static Summary makeSummary(const RateState& state, uint64_t suppressed);
+    bool enqueue(LogLevel level, const std::string& message);
+    template <typename Sink>
+    bool dequeue(Sink&& sink);
+    void writerThreadFunction();
+    void writeDirect(LogLevel level, const char* data, size_t length);
+    void drainForCrash();
+    static void crashSignalHandler(int signal);
+    static size_t formatLine(char* out, size_t capacity, LogLevel level, const std::string& message);
+    static const char* levelToString(LogLevel level);
+
+    // Copie le modèle jusqu'au prochain "{}" (consommé); false en fin de modèle
+    static bool appendLiteral(std::string& out, const char*& cursor);
+    static void appendFloating(std::string& out, double value);
+
+    template <typename T>
+    static void appendValue(std::string& out, const T& value) {
+        if constexpr (std::is_same<T, bool>::value) {
+            out += value ? "true" : "false";
+        } else if constexpr (std::is_same<T, char>::value) {
+            out += value;
+        } else if constexpr (std::is_integral<T>::value) {
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        } else if constexpr (std::is_floating_point<T>::value) {
+            appendFloating(out, static_cast<double>(value));
+        } else if constexpr (std::is_enum<T>::value) {
+            appendValue(out, static_cast<typename std::underlying_type<T>::type>(value));
+        } else {
+            out += std::string_view(value);
+        }
+    }
+
+    static inline std::atomic<LogLevel> currentLevel_{LogLevel::INFO};
+    std::atomic<uint32_t> rateLimitBurst_{5};
+    std::atomic<int64_t> rateLimitIntervalMs_{60000};
+    std::atomic<uint64_t> suppressed_{0};
+    std::mutex rateMutex_;                          // Enregistrement et balayage des états seulement
+    std::unordered_map<RateKey, std::shared_ptr<RateState>, RateKeyHash> rateStates_;
+    std::atomic<int64_t> nextRateSweepMs_{0};
+    // États déjà enregistrés, par site, pour le contexte courant du thread
+    static thread_local std::unordered_map<const LogSite*, std::shared_ptr<RateState>> rateCache_;
+    int logFd_ = -1;
     std::mutex logMutex_;
     bool logToConsole_ = true;
+
+    // Mode asynchrone
+    std::unique_ptr<Record[]> ring_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) std::atomic<size_t> dequeuePos_{0};
+    std::atomic<size_t> writtenPos_{0};             // Lignes effectivement écrites
+    std::atomic<bool> async_{false};
+    LogOverflowPolicy overflowPolicy_ = LogOverflowPolicy::DROP;
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t droppedReported_ = 0;                  // Thread d'écriture seulement
+    std::atomic<bool> writerSleeping_{false};
+    bool stopWriter_ = false;
+    std::mutex writerMutex_;
+    std::condition_variable writerCv_;
+    std::condition_variable flushedCv_;
+    std::unique_ptr<std::thread> writerThread_;
+};
+
+/**
+ * Contexte de log temporaire du thread courant, rétabli en fin de portée:
+ * les messages émis pour une ligne depuis un thread qui en gère plusieurs
+ * (démarrage, rechargement) sont limités par ligne et non par site seul.
+ */
+class ScopedLogContext {
+public:
+    explicit ScopedLogContext(const std::string& context) : previous_(Logger::getThreadContext()) {
+        Logger::setThreadContext(context);
+    }
+    ~ScopedLogContext() { Logger::setThreadContext(previous_); }
+
+    ScopedLogContext(const ScopedLogContext&) = delete;
+    ScopedLogContext& operator=(const ScopedLogContext&) = delete;
+
+private:
+    std::string previous_;
 };
 
-// Macros pour faciliter l'utilisation
-#define LOG_DEBUG(msg) Logger::getInstance().debug(msg)
-#define LOG_INFO(msg) Logger::getInstance().info(msg)
-#define LOG_WARN(msg) Logger::getInstance().warn(msg)
-#define LOG_ERROR(msg) Logger::getInstance().error(msg)
+// Macros pour faciliter l'utilisation; chaque expansion est un site d'appel distinct.
+// Les arguments ne sont évalués que si le niveau est actif:
+//   LOG_INFO("Cadence mise à jour pour {}: {}ms", id, periodMs);
+//   LOG_INFO("Message déjà construit: " + detail);
+#define LOG_AT_SITE(level, ...) \
+    do { \
+        if constexpr (static_cast<int>(level) >= LOG_MIN_LEVEL) { \
+            if (Logger::isEnabled(level)) { \
+                static const LogSite logSite_{__FILE__, __LINE__}; \
+                Logger::getInstance().logAt(logSite_, level, Logger::format(__VA_ARGS__)); \
+            } \
+        } \
+    } while (0)
 
+#define LOG_DEBUG(...) LOG_AT_SITE(LogLevel::DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT_SITE(LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT_SITE(LogLevel::WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT_SITE(LogLevel::ERROR, __VA_ARGS__)
@@ -5,8 +5,10 @@
 #include <vector>
 #include <memory>
 #include <mqtt/async_client.h>
+#include <nlohmann/json.hpp>
 #include "ModbusData.h"
 #include "ConfigManager.h"
+#include "ThreadTuning.h"
 #include "AcquisitionThread.h"
 
 /**
@@ -22,6 +24,9 @@ public:
     void stop();
     void join();
     
+    // Réglages d'ordonnancement appliqués au démarrage du thread
+    void setThreadTuning(const ThreadTuning& tuning) { threadTuning_ = tuning; }
+    
     // Gestion des threads d'acquisition
     void addAcquisitionThread(std::shared_ptr<AcquisitionThread> acquisitionThread);
     void removeAcquisitionThread(const std::string& lineId);
@@ -36,12 +41,14 @@ private:
     void disconnectFromMqtt();
     void collectAndPublishData();
     std::string aggregateDataToJson();
+    nlohmann::json timeSeriesToJson(const std::vector<ModbusData>& samples) const;
     
     MqttConfig config_;
     std::unique_ptr<std::thread> thread_;
     std::atomic<bool> running_;
     std::atomic<bool> stopRequested_;
     std::atomic<bool> connected_;
+    ThreadTuning threadTuning_;
     
     // Client MQTT
     std::unique_ptr<mqtt::async_client> mqttClient_;
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * File circulaire sans verrou à un seul producteur et un seul consommateur.
+ *
+ * Les emplacements sont préalloués à la construction ; la capacité est
+ * arrondie à la puissance de deux supérieure. push() ne doit être appelée
+ * que depuis le thread producteur, pop() et empty() que depuis le thread
+ * consommateur. Lorsque la file est pleine, l'élément poussé est rejeté et
+ * le compteur de débordement est incrémenté.
+ */
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t capacity)
+        : mask_(roundUpPowerOfTwo(capacity) - 1)
+        , slots_(mask_ + 1) {
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // Côté producteur
+    bool push(T&& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cachedTail_ > mask_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head - cachedTail_ > mask_) {
+                overflowCount_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots_[head & mask_] = std::move(value);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Côté consommateur
+    bool pop(T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cachedHead_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail == cachedHead_) {
+                return false;
+            }
+        }
+        value = std::move(slots_[tail & mask_]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail_.load(std::memory_order_relaxed) == head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+    unsigned long long overflowCount() const { return overflowCount_.load(std::memory_order_relaxed); }
+
+private:
+    static size_t roundUpPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t mask_;
+    std::vector<T> slots_;
+
+    // Indices séparés sur des lignes de cache distinctes pour éviter le faux partage
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t cachedTail_ = 0;               // Copie locale du producteur
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t cachedHead_ = 0;               // Copie locale du consommateur
+    alignas(64) std::atomic<unsigned long long> overflowCount_{0};
+};
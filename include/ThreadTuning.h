@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * Réglages d'ordonnancement d'un thread (nom, affinité CPU, classe temps réel)
+ */
+struct ThreadTuning {
+    std::string name;               // Nom visible dans top/ps (tronqué à 15 caractères)
+    std::vector<int> cpuAffinity;   // CPUs autorisés, vide = pas de restriction
+    std::string schedPolicy = "other"; // "other" ou "fifo"
+    int schedPriority = 0;          // Priorité SCHED_FIFO (1-99)
+    bool prefaultStack = false;     // Pré-charger la pile du thread en mémoire
+};
+
+/**
+ * Applique les réglages au thread appelant. Les échecs (droits insuffisants,
+ * CPU inexistant...) sont journalisés sans interrompre le thread.
+ * @return true si tous les réglages demandés ont été appliqués
+ */
+bool applyThreadTuning(const ThreadTuning& tuning);
+
+/**
+ * Verrouille la mémoire du processus (mlockall) et désactive la restitution
+ * du tas au système pour éviter les défauts de page pendant l'acquisition.
+ */
+bool lockProcessMemory();
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace modbustt {
 
@@ -16,6 +17,11 @@ struct RegisterConfig {
     double offset = 0.0;
 };
 
+/**
+ * @brief Liste de registres immuable, partageable entre collecteurs identiques.
+ */
+using RegisterTable = std::vector<RegisterConfig>;
+
 /**
  * @brief Configuration pour une connexion Modbus RTU.
  */
@@ -39,6 +45,14 @@ struct CollectorConfig {
     RtuConfig rtu_settings;
     int acquisition_frequency_ms = 200;
     std::vector<RegisterConfig> registers;
+    // Table partagée, prioritaire sur registers: un seul exemplaire pour tous les collecteurs d'un profil
+    std::shared_ptr<const RegisterTable> register_table;
+
+    // Ordonnancement du thread de collecte
+    std::vector<int> cpu_affinity;      // CPUs autorisés, vide = pas de restriction
+    std::string sched_policy = "other"; // "other" ou "fifo"
+    int sched_priority = 0;
+    bool prefault_stack = false;
 };
 
 } // namespace modbustt
\ No newline at end of file
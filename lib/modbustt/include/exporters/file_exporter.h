@@ -1,12 +1,27 @@
 #pragma once
 
 #include "iexporter.h"
-#include <fstream>
+#include "payload_encoding.h"
+#include "frame_compressor.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <thread>
 
 namespace modbustt {
 namespace exporters {
 
+/**
+ * @brief Exporter écrivant les trames dans un fichier (JSON Lines ou binaire préfixé).
+ *
+ * En mode tamponné, les enregistrements sont accumulés en mémoire et écrits
+ * par lots (taille ou intervalle atteint), avec fdatasync optionnel après chaque
+ * lot. Le fichier actif peut être renommé atomiquement en segment horodaté
+ * lorsqu'il dépasse une taille ou un âge donnés. Avec la compression, chaque
+ * lot devient une trame gzip/zstd autonome, compressée sur un thread dédié.
+ */
 class FileExporter : public IExporter {
 public:
     ~FileExporter() override;
@@ -15,14 +30,64 @@ public:
     bool connect() override;
     void disconnect() override;
     void export_data(const TelemetryData& data) override;
-    bool is_connected() const override { return file_stream_.is_open(); }
+    bool is_connected() const override { return open_; }
+
+    /**
+     * @brief Écrit immédiatement le contenu du tampon sur disque.
+     */
+    void flush();
 
 private:
-    std::ofstream file_stream_;
+    bool openSegment();
+    bool reopenSegment();
+    void closeSegment();
+    void rotateSegment();
+    void submitChunk(std::string& pending);
+    void writeChunk(const std::string& chunk);
+    void compressionThreadFunction();
+    void stopCompressionThread();
+    bool writeAll(const char* data, size_t size);
+    bool segmentExpired() const;
+    void flushThreadFunction();
+    std::string rotatedSegmentPath() const;
+
+    std::atomic<int> fd_{-1};
+    std::atomic<bool> open_{false};  // De connect() à disconnect(), rotation et réouverture comprises
+    std::chrono::steady_clock::time_point next_reopen_;
+    uint64_t lost_chunks_ = 0;      // Lots écrits sans segment ouvert (io_mutex_)
     std::string filepath_;
-    mutable std::mutex mutex_;
-    
+    std::string active_path_;       // filepath_ suivi de l'extension de compression
+    PayloadEncoding encoding_ = PayloadEncoding::JSON;
+
+    // Écriture tamponnée (désactivée: un write() par enregistrement)
+    bool buffered_ = false;
+    size_t buffer_size_ = 1024 * 1024;
+    int flush_interval_ms_ = 1000;
+    bool fdatasync_ = false;
+    std::string buffer_;
+
+    // Rotation des segments (0 = désactivée)
+    size_t max_segment_bytes_ = 0;
+    int max_segment_age_s_ = 0;
+    size_t segment_bytes_ = 0;
+    std::chrono::steady_clock::time_point segment_opened_at_;
+
+    mutable std::mutex mutex_;      // Protège buffer_ et la configuration
+    std::mutex io_mutex_;           // Sérialise les écritures et la rotation
+    std::unique_ptr<std::thread> flush_thread_;
+    std::condition_variable flush_cv_;
+    bool flush_stop_ = false;
+
+    // Compression en arrière-plan (désactivée si compressor_ est nul)
+    std::unique_ptr<FrameCompressor> compressor_;
+    size_t max_pending_chunks_ = 64;
+    std::deque<std::string> compress_queue_;
+    std::mutex compress_mutex_;
+    std::condition_variable compress_cv_;
+    std::unique_ptr<std::thread> compress_thread_;
+    bool compress_stop_ = false;
+    uint64_t dropped_chunks_ = 0;
 };
 
 } // namespace exporters
-} // namespace modbustt
\ No newline at end of file
+} // namespace modbustt
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace modbustt {
+namespace exporters {
+
+/**
+ * @brief Compresse des blocs en trames autonomes.
+ *
+ * Chaque appel produit une trame complète (membre gzip ou trame zstd) : un
+ * fichier formé de trames concaténées reste lisible par gzip -d / zstd -d, et
+ * une interruption brutale ne fait perdre que la trame en cours d'écriture.
+ */
+class FrameCompressor {
+public:
+    virtual ~FrameCompressor() = default;
+
+    virtual bool compress_frame(const std::string& input, std::string& output) = 0;
+    /**
+     * @brief Extension ajoutée aux fichiers produits (".gz", ".zst").
+     */
+    virtual const char* file_suffix() const = 0;
+};
+
+/**
+ * @brief Crée un compresseur "gzip" ou "zstd".
+ * @return nullptr si l'algorithme est inconnu ou absent de cette compilation.
+ */
+std::unique_ptr<FrameCompressor> make_frame_compressor(const std::string& algorithm, int level);
+
+} // namespace exporters
+} // namespace modbustt
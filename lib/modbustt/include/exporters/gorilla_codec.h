@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace modbustt {
+namespace exporters {
+
+/**
+ * @brief Encodeur de séries temporelles façon Gorilla.
+ *
+ * Les horodatages (ms) sont codés en delta-of-delta, les valeurs par XOR avec
+ * la valeur précédente. Une série régulière et lentement variable descend à
+ * quelques bits par point.
+ */
+class GorillaEncoder {
+public:
+    void append(int64_t timestamp_ms, double value);
+
+    size_t count() const { return count_; }
+    int64_t first_timestamp() const { return first_timestamp_; }
+    int64_t last_timestamp() const { return prev_timestamp_; }
+
+    /**
+     * @brief Octets encodés (le dernier octet peut être partiellement rempli).
+     */
+    const std::string& bytes() const { return bytes_; }
+
+private:
+    void write_bits(uint64_t value, int bits);
+
+    std::string bytes_;
+    int bit_pos_ = 0; // Bits utilisés dans le dernier octet (0 = octet plein ou vide)
+
+    size_t count_ = 0;
+    int64_t first_timestamp_ = 0;
+    int64_t prev_timestamp_ = 0;
+    int64_t prev_delta_ = 0;
+    uint64_t prev_value_bits_ = 0;
+    int prev_leading_ = -1;
+    int prev_trailing_ = 0;
+};
+
+/**
+ * @brief Décodeur symétrique de GorillaEncoder.
+ */
+class GorillaDecoder {
+public:
+    GorillaDecoder(const char* data, size_t size, size_t count);
+
+    /**
+     * @brief Lit le point suivant.
+     * @return false une fois les count points lus ou si les données sont tronquées.
+     */
+    bool next(int64_t& timestamp_ms, double& value);
+
+private:
+    bool read_bits(int bits, uint64_t& value);
+    bool read_bit(bool& bit);
+
+    const unsigned char* data_;
+    size_t size_bits_;
+    size_t pos_ = 0;
+    size_t remaining_;
+    size_t index_ = 0;
+
+    int64_t prev_timestamp_ = 0;
+    int64_t prev_delta_ = 0;
+    uint64_t prev_value_bits_ = 0;
+    int prev_leading_ = 0;
+    int prev_trailing_ = 0;
+};
+
+} // namespace exporters
+} // namespace modbustt
@@ -1,29 +1,134 @@
 #pragma once
 
 #include "iexporter.h"
+#include <atomic>
 #include <deque>
 #include <mutex>
+#include <vector>
 
 namespace modbustt {
 namespace exporters {
 
+/**
+ * @brief Trame conservée en mémoire avec sa position dans le flux du collecteur.
+ */
+struct TelemetryEntry {
+    uint64_t cursor;        // Numéro de séquence croissant par collecteur (à partir de 1)
+    TelemetryData data;
+};
+
+/**
+ * @brief Résultat d'une lecture incrémentale.
+ */
+struct TelemetryReadResult {
+    std::vector<TelemetryEntry> entries;
+    uint64_t next_cursor = 0;   // À repasser au prochain appel de read_since()
+    uint64_t missed = 0;        // Trames écrasées avant d'avoir été lues
+};
+
+/**
+ * @brief Historique récent en mémoire, un anneau préalloué par collecteur.
+ *
+ * Chaque anneau a un seul écrivain (le thread du collecteur) et des lecteurs
+ * sans verrou: chaque case est protégée par un compteur de séquence (seqlock),
+ * le lecteur recommence si la case a été réécrite pendant sa copie. Les noms
+ * des points sont factorisés dans des schémas immuables, les cases ne
+ * contiennent que des valeurs numériques. Chaque anneau garde jusqu'à 64
+ * schémas: un jeu de points déjà vu réutilise le sien, sinon le schéma utilisé
+ * le moins récemment est remplacé. Si des cases le référencent encore (plus de
+ * 64 jeux de points dans l'anneau), ces trames sont perdues pour les lecteurs
+ * et un avertissement est émis.
+ *
+ * Configuration: capacity (trames par collecteur, 1000), max_points (valeurs
+ * par trame, 64), max_collectors (anneaux, 64; les collecteurs suivants ne
+ * sont pas conservés).
+ *
+ * configure() doit précéder toute écriture: il réalloue les anneaux.
+ */
 class InMemoryExporter : public IExporter {
 public:
+    InMemoryExporter();
+    ~InMemoryExporter() override;
+
     void configure(const nlohmann::json& config) override;
     bool connect() override { return true; }
     void disconnect() override {}
     void export_data(const TelemetryData& data) override;
     bool is_connected() const override { return true; }
 
-    // Specific method to retrieve data
+    // Lectures non destructives, utilisables depuis plusieurs threads
+    std::vector<std::string> collectors() const;
+    std::vector<TelemetryEntry> latest(const std::string& collector_id, size_t count) const;
+    std::vector<TelemetryEntry> range(const std::string& collector_id,
+                                      std::chrono::system_clock::time_point from,
+                                      std::chrono::system_clock::time_point to) const;
+    TelemetryReadResult read_since(const std::string& collector_id, uint64_t cursor, size_t max_count = 0) const;
+
+    /**
+     * @brief Retourne les trames de tous les collecteurs non encore retournées par flush().
+     *
+     * Les autres lecteurs ne sont pas affectés.
+     */
     std::deque<TelemetryData> flush();
-    size_t size() const;
+    size_t size() const;    // Trames conservées, tous collecteurs confondus
 
 private:
-    std::deque<TelemetryData> data_queue_;
-    mutable std::mutex mutex_;
-    size_t max_size_ = 1000;
+    struct Schema {
+        std::vector<std::string> names;
+        uint32_t tag;       // Index dans Ring::schemas + kMaxSchemas * remplacements de l'index
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // Impair pendant une écriture
+        std::atomic<uint64_t> cursor{0};
+        std::atomic<int64_t> timestamp_ms{0};
+        std::atomic<uint32_t> schema{0};    // Schema::tag
+        std::atomic<uint32_t> count{0};
+    };
+
+    static constexpr size_t kMaxSchemas = 64;
+
+    struct Ring {
+        Ring(const std::string& id, size_t ring_capacity, size_t ring_max_points);
+        ~Ring();
+
+        std::string collector_id;
+        size_t capacity;
+        size_t max_points;
+        std::unique_ptr<Slot[]> slots;
+        std::unique_ptr<std::atomic<double>[]> values;   // capacity * max_points
+        std::atomic<uint64_t> head{0};                   // Curseur de la dernière trame publiée
+
+        // Un schéma publié n'est jamais modifié; remplacé, il est libéré quand
+        // aucune lecture n'est en cours
+        std::atomic<const Schema*> schemas[kMaxSchemas];
+        mutable std::atomic<uint32_t> readers{0};        // Lectures en cours
+        uint64_t schema_last_cursor[kMaxSchemas] = {};   // Écrivain seulement: dernière trame par schéma
+        uint32_t schema_count = 0;                       // Écrivain seulement
+        uint32_t current_schema = 0;                     // Écrivain seulement
+        std::vector<const Schema*> retired;              // Écrivain seulement
+        bool truncation_warned = false;
+        bool schemas_exhausted_warned = false;
+
+        std::mutex writer_mutex;                         // Sérialise d'éventuels écrivains multiples
+        uint64_t flush_cursor = 0;                       // Protégé par InMemoryExporter::mutex_
+    };
+
+    Ring* findRing(const std::string& collector_id) const;
+    Ring* findOrCreateRing(const std::string& collector_id);
+    static uint32_t schemaFor(Ring& ring, const TelemetryData& data, uint64_t cursor);
+    static uint32_t changeSchema(Ring& ring, const TelemetryData& data, uint64_t cursor);
+    static bool readSlot(const Ring& ring, uint64_t cursor, TelemetryEntry& entry); // Lecteurs comptés dans ring.readers
+
+    size_t capacity_ = 1000;
+    size_t max_points_ = 64;
+    size_t max_collectors_ = 64;
 
+    // Anneaux publiés de manière atomique: la recherche par les lecteurs est sans verrou
+    std::unique_ptr<std::atomic<Ring*>[]> rings_;
+    std::atomic<size_t> ring_count_{0};
+    std::vector<std::unique_ptr<Ring>> owned_rings_;
+    mutable std::mutex mutex_;      // Création des anneaux et curseurs de flush()
 };
 
 } // namespace exporters
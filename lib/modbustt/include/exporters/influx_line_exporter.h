@@ -0,0 +1,77 @@
+#pragma once
+
+#include "iexporter.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace modbustt {
+namespace exporters {
+
+/**
+ * @brief Exporter au format "line protocol" d'InfluxDB (UDP ou TCP).
+ *
+ * Une trame donne une ligne: <measurement>,collector_id=<id> <point>=<valeur>,... <ns>.
+ * Les lignes sont rendues directement dans le lot courant (sans allocation par
+ * ligne). En UDP, un lot est un datagramme limité à max_datagram_bytes pour
+ * éviter la fragmentation IP; en TCP, les lots sont envoyés sur une connexion
+ * rétablie au besoin. Les lots sont envoyés par un thread dédié.
+ */
+class InfluxLineExporter : public IExporter {
+public:
+    ~InfluxLineExporter() override;
+
+    void configure(const nlohmann::json& config) override;
+    bool connect() override;
+    void disconnect() override;
+    void export_data(const TelemetryData& data) override;
+    bool is_connected() const override { return connected_; }
+
+private:
+    /**
+     * @brief Rend une trame en line protocol à la fin de out.
+     * @return false si aucune valeur n'est représentable (NaN/inf ignorés).
+     */
+    bool render_line(const TelemetryData& data, std::string& out);
+    bool openSocket();
+    void closeSocket();
+    bool sendBatch(const std::string& batch);
+    void sealBatch();
+    void senderThreadFunction();
+
+    bool udp_ = true;
+    std::string host_ = "127.0.0.1";
+    int port_ = 8089;
+    std::string measurement_ = "modbus";
+    size_t max_batch_bytes_ = 1400;   // Taille d'un datagramme UDP ou d'un lot TCP
+    int flush_interval_ms_ = 100;
+    size_t max_pending_batches_ = 256;
+    int reconnect_interval_ms_ = 1000;
+
+    int sock_ = -1;                   // Détenu par le thread d'envoi une fois démarré
+    std::atomic<bool> connected_{false};
+    std::chrono::steady_clock::time_point next_reconnect_;
+
+    // Préfixe "measurement,collector_id=<id> " échappé, par collecteur
+    std::map<std::string, std::string> prefixes_;
+    std::string line_;                // Tampon de rendu réutilisé
+    std::string batch_;               // Lot en cours de remplissage
+    std::chrono::steady_clock::time_point batch_opened_at_;
+    std::deque<std::string> ready_;   // Lots prêts à l'envoi
+    std::vector<std::string> spare_;  // Lots envoyés dont la capacité est réutilisée
+    uint64_t dropped_batches_ = 0;
+    bool oversize_warned_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::unique_ptr<std::thread> sender_thread_;
+    bool stop_ = false;
+};
+
+} // namespace exporters
+} // namespace modbustt
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "iexporter.h"
+#include <modbus/modbus.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace modbustt {
+namespace exporters {
+
+/**
+ * @brief Serveur Modbus TCP exposant les dernières valeurs collectées ("mbserve").
+ *
+ * Chaque point configuré est placé dans une image de registres holding/input
+ * (uint16, int16, uint32, int32 ou float32). Un thread unique sert tous les
+ * clients SCADA via poll(), en lecture seule: les écritures sont refusées.
+ * Les sockets clientes sont non bloquantes et chaque client garde sa requête
+ * partielle: un client lent ne retarde pas les autres.
+ *
+ * L'image est multi-tampons: les collecteurs publient une image complète,
+ * le serveur bascule sur la plus récente avant de répondre. Aucun des deux
+ * n'attend l'autre.
+ */
+class ModbusServerExporter : public IExporter {
+public:
+    ~ModbusServerExporter() override;
+
+    void configure(const nlohmann::json& config) override;
+    bool connect() override;
+    void disconnect() override;
+    void export_data(const TelemetryData& data) override;
+    bool is_connected() const override { return running_; }
+
+    size_t client_count() const { return client_count_; }
+    uint64_t requests_served() const { return requests_served_; }
+
+private:
+    enum class ValueType { UINT16, INT16, UINT32, INT32, FLOAT32 };
+
+    /**
+     * @brief Emplacement d'un point dans l'image.
+     */
+    struct PointMapping {
+        bool input_table;           // Registres input (FC 04) ou holding (FC 03)
+        int address;                // Relatif au début de la table
+        ValueType type;
+        double scale = 1.0;         // registre = (valeur - offset) / scale
+        double offset = 0.0;
+        bool swap_words = false;    // Mot de poids faible en premier (32 bits)
+    };
+
+    /**
+     * @brief Client connecté et requête en cours de réception.
+     */
+    struct Client {
+        int fd;
+        size_t length = 0;                                  // Octets reçus de la requête en cours
+        uint8_t request[MODBUS_TCP_MAX_ADU_LENGTH];
+    };
+
+    struct RegisterImage {
+        std::vector<uint16_t> holding;
+        std::vector<uint16_t> input;
+    };
+
+    static constexpr uint8_t kFresh = 0x4;
+
+    void writePoint(const PointMapping& mapping, double value);
+    void serverThreadFunction();
+    void handleReadable(int client_fd);
+    bool replyTo(int client_fd, const uint8_t* request, int length);
+    void closeClient(int client_fd);
+
+    std::string listen_address_ = "0.0.0.0";
+    int port_ = 1502;
+    size_t max_clients_ = 32;
+    int holding_start_ = 0;
+    int holding_count_ = 1000;
+    int input_start_ = 0;
+    int input_count_ = 1000;
+
+    // collector_id -> point -> emplacements
+    std::unordered_map<std::string, std::unordered_map<std::string, std::vector<PointMapping>>> mappings_;
+
+    // Triple tampon: l'écrivain et le serveur échangent leurs tampons via latest_
+    RegisterImage master_;          // Valeurs courantes, côté écrivain
+    RegisterImage buffers_[3];
+    uint8_t write_index_ = 0;       // Écrivain (writer_mutex_)
+    uint8_t read_index_ = 2;        // Thread serveur
+    std::atomic<uint8_t> latest_{1};
+    std::mutex writer_mutex_;
+
+    modbus_t* ctx_ = nullptr;
+    modbus_mapping_t* mapping_ = nullptr;
+    uint16_t* owned_holding_ = nullptr;   // Tableaux alloués par libmodbus, restaurés avant libération
+    uint16_t* owned_input_ = nullptr;
+    int listen_fd_ = -1;
+    std::vector<Client> clients_;       // Thread serveur
+
+    std::unique_ptr<std::thread> server_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> client_count_{0};
+    std::atomic<uint64_t> requests_served_{0};
+};
+
+} // namespace exporters
+} // namespace modbustt
@@ -1,14 +1,38 @@
 #pragma once
 
 #include "iexporter.h"
+#include "payload_encoding.h"
 #include <mqtt/async_client.h>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <unordered_map>
 
 namespace modbustt {
 namespace exporters {
 
-class MqttExporter : public IExporter, public virtual mqtt::callback {
+/**
+ * @brief Statistiques de publication de l'exporter MQTT.
+ */
+struct MqttExporterStats {
+    uint64_t batches_published = 0;   // Messages MQTT publiés
+    uint64_t frames_published = 0;    // Trames de télémétrie publiées
+    uint64_t bytes_published = 0;
+    uint64_t frames_dropped = 0;      // Trames perdues (file pleine ou déconnexion), au plus une fois chacune
+    uint64_t points_dropped = 0;      // Messages par point ({point}) perdus
+    uint64_t publish_failures = 0;
+    size_t in_flight = 0;             // Messages en attente d'acquittement
+    size_t last_batch_frames = 0;
+    size_t last_batch_bytes = 0;
+    double avg_batch_frames = 0.0;
+    double last_ack_latency_ms = 0.0;
+    double avg_ack_latency_ms = 0.0;
+    double max_ack_latency_ms = 0.0;
+};
+
+class MqttExporter : public IExporter, public virtual mqtt::callback, public virtual mqtt::iaction_listener {
 public:
     MqttExporter();
     ~MqttExporter() override;
@@ -19,23 +43,122 @@ public:
     void export_data(const TelemetryData& data) override;
     bool is_connected() const override { return connected_; }
 
+    MqttExporterStats get_stats() const;
+
+    /**
+     * @brief Version MQTT du client (MQTTVERSION_5 si content_type_indicator vaut "property").
+     */
+    int get_mqtt_version() const { return mqtt_version_; }
+
+    /**
+     * @brief Options de connexion produites par configure().
+     */
+    const mqtt::connect_options& get_connect_options() const { return conn_opts_; }
+
     // MQTT Callbacks
     void connected(const std::string& cause) override;
     void connection_lost(const std::string& cause) override;
     void delivery_complete(mqtt::delivery_token_ptr token) override;
 
+    // Action listener: acquittement (ou échec) d'une publication
+    void on_success(const mqtt::token& token) override;
+    void on_failure(const mqtt::token& token) override;
+
 private:
+    /**
+     * @brief Lot de trames sérialisé sous forme de tableau JSON.
+     */
+    struct Batch {
+        std::string payload;
+        size_t frames = 0;
+        size_t points = 0;                      // Messages par point: 1, sinon 0
+        const std::string* topic = nullptr;     // Topic du cache, nullptr: publish_topic_
+        std::chrono::steady_clock::time_point opened_at;
+    };
+
+    /**
+     * @brief Contexte d'une publication en attente d'acquittement.
+     */
+    struct InFlight {
+        std::chrono::steady_clock::time_point sent_at;
+        size_t frames;
+        size_t points;
+    };
+
+    /**
+     * @brief Routage des messages selon topic_template.
+     */
+    enum class TopicMode {
+        SINGLE,         // Un seul topic pour toutes les trames
+        PER_COLLECTOR,  // {collector_id}: une trame par message
+        PER_POINT       // {point}: un message par point
+    };
+
+    /**
+     * @brief Topics rendus d'un collecteur, calculés à la première trame.
+     */
+    struct CollectorTopics {
+        std::string frame_topic;
+        std::unordered_map<std::string, std::string> point_topics;
+    };
+
+    bool batching_enabled() const { return linger_ms_ > 0; }
+    void exportPoints(const TelemetryData& data, const std::string& timestamp);
+    const std::string& collectorTopic(const std::string& collector_id);
+    const std::string& pointTopic(const std::string& collector_id, const std::string& point);
+    std::string renderTopic(const std::string& collector_id, const std::string* point) const;
+    void flushThreadFunction();
+    void sealPendingBatch();
+    bool publishBatch(Batch& batch, bool wait_for_window);
+    void completeInFlight(const mqtt::token& token, bool success);
+
     std::unique_ptr<mqtt::async_client> client_;
     std::string server_uri_;
     std::string client_id_;
     std::string topic_;
+    std::string publish_topic_;     // topic_ éventuellement suffixé par l'encodage
+    std::string topic_suffix_;      // Suffixe d'encodage ajouté à chaque topic rendu
     int qos_ = 1;
+    bool retained_ = false;
+
+    // Routage par collecteur ou par point; les topics rendus ne sont jamais retirés du cache
+    std::string topic_template_;
+    TopicMode topic_mode_ = TopicMode::SINGLE;
+    std::unordered_map<std::string, CollectorTopics> topic_cache_;
+    std::mutex topic_mutex_;
     std::string username_;
     std::string password_;
     mqtt::connect_options conn_opts_;
+    int mqtt_version_ = MQTTVERSION_DEFAULT;
     std::atomic<bool> connected_{false};
     std::mutex connection_mutex_;
+
+    // Encodage des messages
+    PayloadEncoding encoding_ = PayloadEncoding::JSON;
+    bool use_content_type_property_ = false;
+    mqtt::properties publish_properties_;
+
+    // Regroupement des trames (désactivé si linger_ms_ == 0)
+    int linger_ms_ = 0;
+    size_t max_batch_bytes_ = 64 * 1024;
+    size_t max_queued_batches_ = 16;
+    size_t max_in_flight_ = 64;     // Fenêtre des lots, appliquée seulement au regroupement
+
+    Batch pending_;                 // Lot en cours de remplissage
+    std::deque<Batch> ready_;       // Lots scellés en attente de publication
+    std::mutex batch_mutex_;
+    std::condition_variable batch_cv_;
+    std::unique_ptr<std::thread> flush_thread_;
+    bool flush_stop_ = false;
+
+    // Fenêtre de publications non acquittées et statistiques
+    size_t in_flight_ = 0;
+    std::condition_variable in_flight_cv_;
+    MqttExporterStats stats_;
+    double total_ack_latency_ms_ = 0.0;
+    uint64_t acked_batches_ = 0;
+    mutable std::mutex stats_mutex_;
 };
 
 } // namespace exporters
-} // namespace modbustt
\ No newline at end of file
+} // namespace modbustt
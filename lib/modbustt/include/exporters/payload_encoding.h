@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../telemetry_data.h"
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace modbustt {
+namespace exporters {
+
+/**
+ * @brief Encodage des messages produits par les exporters réseau et fichier.
+ */
+enum class PayloadEncoding { JSON, CBOR, MSGPACK };
+
+/**
+ * @brief Convertit le nom d'encodage de la configuration ("json", "cbor", "msgpack").
+ * Un nom inconnu est signalé et remplacé par JSON.
+ */
+PayloadEncoding parse_encoding(const std::string& name);
+
+const char* encoding_name(PayloadEncoding encoding);
+
+/**
+ * @brief Type MIME de l'encodage (application/json, application/cbor, application/msgpack).
+ */
+const char* content_type(PayloadEncoding encoding);
+
+/**
+ * @brief Sérialise un document JSON dans l'encodage demandé.
+ */
+std::string encode_payload(const nlohmann::json& document, PayloadEncoding encoding);
+
+/**
+ * @brief Variante ajoutant le document encodé à la fin de out (capacité réutilisée).
+ */
+void encode_payload(const nlohmann::json& document, PayloadEncoding encoding, std::string& out);
+
+/**
+ * @brief Trame standard {"collector_id", "timestamp", "values"} dans l'encodage demandé.
+ *
+ * Le premier exporter qui demande un encodage le produit, les suivants
+ * réutilisent les mêmes octets (cache porté par la trame). Le JSON est écrit
+ * directement, sans document intermédiaire, au format de json::dump().
+ *
+ * Une trame est exportée par un seul thread à la fois: le cache n'est pas protégé.
+ */
+const std::string& encoded_frame(const TelemetryData& data, PayloadEncoding encoding);
+
+/**
+ * @brief Écrit la trame standard dans l'encodage demandé à la fin de out, sans
+ * passer par le cache: pour un tampon que l'appelant conserve (ex: prêté à ZeroMQ).
+ */
+void write_frame(const TelemetryData& data, PayloadEncoding encoding, std::string& out);
+
+/**
+ * @brief Écrit la trame standard en JSON à la fin de out, sans passer par nlohmann::json.
+ */
+void write_frame_json(const TelemetryData& data, std::string& out);
+
+/**
+ * @brief Horodatage UTC "AAAA-MM-JJTHH:MM:SSZ" (20 caractères), à la seconde.
+ *
+ * Le texte de la dernière seconde formatée est conservé par thread: gmtime_r
+ * n'est appelé qu'une fois par seconde. Le pointeur reste valide jusqu'au
+ * prochain appel dans le même thread.
+ */
+const char* format_timestamp_utc(std::chrono::system_clock::time_point timestamp);
+
+/**
+ * @brief Délimiteurs permettant de concaténer des éléments déjà encodés en un tableau.
+ *
+ * Le tableau s'écrit array_prefix(n) + e1 + array_separator() + e2 ... + array_suffix().
+ */
+std::string array_prefix(PayloadEncoding encoding, size_t count);
+const char* array_separator(PayloadEncoding encoding);
+const char* array_suffix(PayloadEncoding encoding);
+
+/**
+ * @brief Préfixe de longueur big-endian sur 4 octets pour le tramage des flux binaires.
+ */
+void append_length_prefix(std::string& out, size_t length);
+
+} // namespace exporters
+} // namespace modbustt
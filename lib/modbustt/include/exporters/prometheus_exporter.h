@@ -0,0 +1,79 @@
+#pragma once
+
+#include "iexporter.h"
+#include "../modbus_collector.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace modbustt {
+namespace exporters {
+
+/**
+ * @brief Point d'accès HTTP /metrics au format texte Prometheus.
+ *
+ * Chaque point devient une série modbus_point_value{collector_id, point}.
+ * Le texte d'exposition est maintenu en permanence: la valeur de chaque série
+ * occupe un champ de largeur fixe réécrit sur place à chaque trame, une
+ * nouvelle série est ajoutée en fin de bloc. Une collecte ne coûte qu'une
+ * copie du texte, quel que soit le nombre de séries. Les compteurs internes
+ * des collecteurs enregistrés sont ajoutés à chaque collecte; un collecteur
+ * dont la source a disparu est retiré, ses séries avec lui (le bloc est alors
+ * reconstruit).
+ */
+class PrometheusExporter : public IExporter {
+public:
+    using StatsSource = std::function<bool(CollectorStats&)>;
+
+    ~PrometheusExporter() override;
+
+    void configure(const nlohmann::json& config) override;
+    bool connect() override;
+    void disconnect() override;
+    void export_data(const TelemetryData& data) override;
+    bool is_connected() const override { return running_; }
+
+    /**
+     * @brief Enregistre (ou remplace) la source des compteurs d'un collecteur.
+     * La source retourne false lorsque le collecteur n'existe plus.
+     */
+    void add_stats_source(const std::string& collector_id, StatsSource source);
+
+    /**
+     * @brief Texte d'exposition complet, tel que servi sur /metrics.
+     * Retire au passage les collecteurs arrêtés.
+     */
+    std::string render();
+
+private:
+    void appendSeries(const std::string& collector_id, const std::string& point);
+    void removeCollectors(const std::vector<std::string>& collector_ids);
+    void renderInternals(std::string& out);
+    void serverThreadFunction();
+    void handleClient(int client_fd);
+
+    std::string listen_address_ = "0.0.0.0";
+    int port_ = 9464;
+    std::string path_ = "/metrics";
+
+    // Texte pré-rendu des valeurs et position du champ valeur de chaque série
+    std::string text_;
+    std::unordered_map<std::string, std::unordered_map<std::string, size_t>> value_offsets_;
+    size_t max_series_ = 100000;
+    bool series_limit_warned_ = false;
+    mutable std::mutex text_mutex_;
+
+    std::map<std::string, StatsSource> stats_sources_;
+    mutable std::mutex stats_mutex_;
+
+    int listen_fd_ = -1;
+    std::unique_ptr<std::thread> server_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> scrapes_{0};
+};
+
+} // namespace exporters
+} // namespace modbustt
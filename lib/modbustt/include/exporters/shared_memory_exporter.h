@@ -0,0 +1,62 @@
+#pragma once
+
+#include "iexporter.h"
+#include "../shm_layout.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace modbustt {
+namespace exporters {
+
+/**
+ * @brief Publie les trames dans une région de mémoire partagée POSIX.
+ *
+ * Destiné aux processus co-localisés (IHM, boucles de régulation): la table
+ * des dernières valeurs et l'anneau de diffusion se lisent sans verrou ni
+ * appel système avec modbustt::SharedMemoryReader (bibliothèque modbustt_shm).
+ * Voir shm_layout.h pour la disposition de la région.
+ *
+ * La région est recréée à chaque connect() et supprimée par disconnect();
+ * les lecteurs déjà attachés voient alors l'état WRITER_CLOSED.
+ */
+class SharedMemoryExporter : public IExporter {
+public:
+    ~SharedMemoryExporter() override;
+
+    void configure(const nlohmann::json& config) override;
+    bool connect() override;
+    void disconnect() override;
+    void export_data(const TelemetryData& data) override;
+    bool is_connected() const override { return header_ != nullptr; }
+
+private:
+    struct CollectorState {
+        uint32_t index;
+        std::unordered_map<std::string, uint32_t> entries;   // Point -> index dans la table
+    };
+
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    CollectorState* collectorFor(const std::string& collector_id);
+    uint32_t entryFor(CollectorState& collector, const std::string& point);
+    shm::Entry& entryAt(uint32_t index) const;
+    shm::RingSlotHeader& slotAt(uint64_t cursor) const;
+
+    std::string name_ = "/modbustt";
+    uint32_t max_collectors_ = 64;
+    uint32_t table_capacity_ = 4096;
+    uint32_t ring_capacity_ = 1024;
+    uint32_t ring_max_points_ = 64;
+
+    uint8_t* base_ = nullptr;
+    shm::Header* header_ = nullptr;
+    size_t mapped_size_ = 0;
+
+    // Un seul écrivain pour les seqlocks: les collecteurs sont sérialisés
+    std::mutex writer_mutex_;
+    std::unordered_map<std::string, CollectorState> collectors_;
+    bool table_full_warned_ = false;
+};
+
+} // namespace exporters
+} // namespace modbustt
@@ -1,21 +1,75 @@
 #pragma once
 
 #include "iexporter.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace modbustt {
 namespace exporters {
 
-// This would require a dependency like spdlog or direct use of syslog.h
+/**
+ * @brief Exporter syslog.
+ *
+ * En format "text" (par défaut), chaque trame est un message syslog() libre.
+ * En format "rfc5424", les trames sont des messages RFC 5424 dont les valeurs
+ * sont portées par les données structurées:
+ *   <14>1 2024-01-01T12:00:00.123Z host modbustt 42 telemetry [telemetry@32473 collector="L1" temp="20.5"]
+ * Les messages sont écrits directement sur une socket datagramme (/dev/log ou
+ * UDP) par un thread dédié, plusieurs datagrammes par appel système (sendmmsg).
+ * Si le démon syslog redémarre, la socket est rouverte par ce thread avec un
+ * délai doublé à chaque échec; les trames de la coupure sont abandonnées.
+ */
 class SyslogExporter : public IExporter {
 public:
+    ~SyslogExporter() override;
+
     void configure(const nlohmann::json& config) override;
     bool connect() override;
     void disconnect() override;
     void export_data(const TelemetryData& data) override;
     bool is_connected() const override;
+
 private:
-    bool connected_ = false;
+    void formatMessage(const TelemetryData& data, std::string& out);
+    void appendTimestamp(std::chrono::system_clock::time_point timestamp, std::string& out);
+    bool openSocket();
+    void closeSocket();
+    void sendMessages(const std::string& buffer, const std::vector<size_t>& ends);
+    void senderThreadFunction();
+
+    std::atomic<bool> connected_{false};
     std::string ident_ = "modbustt"; // Default identifier for syslog
+    bool structured_ = false;
+
+    // Mode rfc5424
+    std::string transport_ = "unix";
+    std::string socket_path_ = "/dev/log";
+    std::string host_ = "127.0.0.1";
+    int port_ = 514;
+    int facility_ = 1;                // user
+    std::string sd_id_ = "telemetry@32473";
+    size_t max_batch_frames_ = 64;    // Datagrammes par appel système
+    int flush_interval_ms_ = 50;
+    size_t max_pending_frames_ = 10000;
+    int reconnect_min_ms_ = 100;
+    int reconnect_max_ms_ = 30000;
+
+    int sock_ = -1;                   // -1 entre une erreur d'envoi et la réouverture
+    std::string header_;              // "<PRI>1 " et champs constants après l'horodatage
+    std::string header_tail_;
+    int64_t cached_second_ = -1;      // Horodatage formaté de la dernière seconde vue
+    std::string cached_timestamp_;
+
+    std::string pending_;             // Messages en attente, concaténés
+    std::vector<size_t> pending_ends_;
+    uint64_t dropped_ = 0;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::unique_ptr<std::thread> sender_thread_;
+    bool stop_ = false;
 };
 
 } // namespace exporters
@@ -1,11 +1,40 @@
 #pragma once
 
 #include "iexporter.h"
+#include "payload_encoding.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace modbustt {
 namespace exporters {
 
-// This would implement a simple TCP client to send data to a listening server
+/**
+ * @brief Statistiques de l'exporter TCP.
+ */
+struct TcpExporterStats {
+    size_t queued_frames = 0;         // Trames en attente d'envoi
+    size_t queued_bytes = 0;
+    uint64_t frames_sent = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t frames_dropped = 0;      // File pleine
+    uint64_t reconnects = 0;
+    bool connected = false;           // Connexion TCP établie (is_connected(): thread d'envoi actif)
+    double bytes_per_second = 0.0;    // Débit mesuré sur la dernière seconde
+};
+
+/**
+ * @brief Client TCP non bloquant (ex: entrée "forward"/"tcp" de Fluentd).
+ *
+ * export_data() ne fait que sérialiser la trame et l'ajouter à une file bornée.
+ * Un thread d'envoi vide la file par lots (sendmsg vectorisé, MSG_NOSIGNAL),
+ * gère les écritures partielles et se reconnecte avec un délai exponentiel.
+ * is_connected() reste vrai tant que le thread d'envoi tourne, connexion établie ou non:
+ * les trames restent en file pendant une déconnexion tant que la file n'est pas pleine.
+ */
 class TcpExporter : public IExporter {
 public:
     ~TcpExporter() override;
@@ -14,17 +43,47 @@ public:
     bool connect() override;
     void disconnect() override;
     void export_data(const TelemetryData& data) override;
-    bool is_connected() const override;
+    bool is_connected() const override { return running_; }
+
+    TcpExporterStats get_stats() const;
 
 private:
-    // Would use OS-specific sockets or a library like Boost.Asio
-    int sock_ = -1;
-    bool connected_ = false;
+    bool openSocket();
+    void closeSocket();
+    bool sendPending();
+    bool peerClosed();
+    void senderThreadFunction();
+
+    int sock_ = -1;                   // Détenu par le thread d'envoi une fois démarré
+    std::atomic<bool> connected_{false};  // Connexion établie
+    std::atomic<bool> running_{false};    // Thread d'envoi démarré: les trames sont acceptées
     std::string host_ = "localhost";
     int port_ = 5170; // Default port for TCP exporter
+    PayloadEncoding encoding_ = PayloadEncoding::JSON;
+    bool length_prefixed_ = false; // Trames préfixées par leur longueur au lieu de '\n'
+
+    // Réglages socket
+    bool nodelay_ = true;
+    bool cork_ = false;               // TCP_CORK pendant l'envoi d'un lot (Linux)
+    int send_buffer_bytes_ = 0;       // SO_SNDBUF (0 = valeur système)
+    int connect_timeout_ms_ = 2000;
+    int reconnect_min_ms_ = 100;
+    int reconnect_max_ms_ = 30000;
 
+    // File d'envoi
+    size_t max_queue_bytes_ = 16 * 1024 * 1024;
+    std::deque<std::string> queue_;
+    size_t queue_bytes_ = 0;
+    size_t head_offset_ = 0;          // Octets déjà envoyés de queue_.front()
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::unique_ptr<std::thread> sender_thread_;
+    bool stop_ = false;
 
+    TcpExporterStats stats_;
+    uint64_t rate_window_bytes_ = 0;
+    std::chrono::steady_clock::time_point rate_window_start_;
 };
 
 } // namespace exporters
-} // namespace modbustt
\ No newline at end of file
+} // namespace modbustt
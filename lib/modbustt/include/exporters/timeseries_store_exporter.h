@@ -0,0 +1,129 @@
+#pragma once
+
+#include "iexporter.h"
+#include "gorilla_codec.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace modbustt {
+namespace exporters {
+
+/**
+ * @brief Point d'une série lue depuis le stockage.
+ */
+struct TimeSeriesPoint {
+    int64_t timestamp_ms;
+    double value;
+};
+
+/**
+ * @brief Agrégat d'un intervalle pour les lectures sous-échantillonnées.
+ */
+struct TimeSeriesBucket {
+    int64_t start_ms;
+    double min;
+    double max;
+    double avg;
+    double last;
+    size_t count;
+};
+
+/**
+ * @brief Stockage local de l'historique, en colonnes compressées façon Gorilla.
+ *
+ * Chaque point (collector_id/nom) alimente un bloc en mémoire. Un bloc plein
+ * (chunk_points), changeant de partition ou ouvert depuis max_chunk_age_s est
+ * scellé et ajouté au fichier de partition horaire <path>/<epoch>.tsdb. Les
+ * blocs scellés ensemble sont écrits en une fois par partition. Les lectures
+ * projettent les partitions en mémoire (mmap). Les partitions plus anciennes
+ * que retention_hours sont supprimées.
+ */
+class TimeSeriesStoreExporter : public IExporter {
+public:
+    ~TimeSeriesStoreExporter() override;
+
+    void configure(const nlohmann::json& config) override;
+    bool connect() override;
+    void disconnect() override;
+    void export_data(const TelemetryData& data) override;
+    bool is_connected() const override { return connected_; }
+
+    // API de lecture
+    std::vector<std::string> list_series() const;
+    std::vector<TimeSeriesPoint> query(const std::string& collector_id, const std::string& point,
+                                       int64_t from_ms, int64_t to_ms) const;
+    std::vector<TimeSeriesBucket> query_downsampled(const std::string& collector_id, const std::string& point,
+                                                    int64_t from_ms, int64_t to_ms, int64_t bucket_ms) const;
+
+    /**
+     * @brief Scelle tous les blocs ouverts et les écrit sur disque.
+     */
+    void flush();
+    void apply_retention();
+
+private:
+    /**
+     * @brief Emplacement d'un bloc scellé dans une partition.
+     */
+    struct ChunkLocation {
+        int64_t partition;      // Début de la partition (s depuis epoch)
+        uint64_t offset;        // Position de l'en-tête dans le fichier
+        int64_t t_min;
+        int64_t t_max;
+    };
+
+    struct OpenChunk {
+        GorillaEncoder encoder;
+        int64_t partition = 0;
+        std::chrono::steady_clock::time_point opened_at;
+    };
+
+    /**
+     * @brief Blocs scellés d'une partition en attente d'écriture.
+     */
+    struct PendingWrite {
+        std::string records;
+        std::vector<std::pair<std::string, ChunkLocation>> chunks;  // Offsets relatifs à records
+    };
+
+    static std::string series_key(const std::string& collector_id, const std::string& point);
+    int64_t partition_of(int64_t timestamp_ms) const;
+    std::string partition_path(int64_t partition) const;
+    void seal_chunk(const std::string& key, OpenChunk& chunk);
+    void write_pending();
+    void sealerThreadFunction();
+    bool load_index();
+    void scan_partition(int64_t partition, const std::string& path);
+    void read_chunks(const std::string& key, int64_t from_ms, int64_t to_ms,
+                     std::vector<TimeSeriesPoint>& out) const;
+
+    std::string path_ = "tsdb";
+    size_t chunk_points_ = 120;
+    int64_t partition_s_ = 3600;
+    int retention_hours_ = 168;
+    int max_chunk_age_s_ = 60;
+    std::atomic<bool> connected_{false};
+
+    std::map<std::string, OpenChunk> open_chunks_;
+    std::map<std::string, std::vector<ChunkLocation>> index_;
+    std::map<int64_t, PendingWrite> pending_;     // Toujours vide hors de mutex_
+    int64_t last_retention_partition_ = 0;
+    mutable std::shared_mutex mutex_;
+
+    // Scellement des blocs trop anciens (séries lentes ou interrompues)
+    std::unique_ptr<std::thread> sealer_thread_;
+    std::mutex sealer_mutex_;
+    std::condition_variable sealer_cv_;
+    bool stopping_ = false;
+};
+
+} // namespace exporters
+} // namespace modbustt
@@ -1,36 +1,90 @@
 #pragma once
 
 #include "iexporter.h"
+#include "payload_encoding.h"
+#include <atomic>
 #include <memory>
-
-// Forward declaration to avoid including zmq.hpp in the header
-namespace zmq {
-    class context_t;
-    class socket_t;
-}
+#include <mutex>
+#include <vector>
 
 namespace modbustt {
 namespace exporters {
 
+/**
+ * @brief Exporter ZeroMQ PUB, diffusion sans broker vers de nombreux abonnés.
+ *
+ * Chaque trame est un message en deux parties: [topic][payload], le topic étant
+ * topic_prefix + collector_id. Les abonnés SUB filtrent par préfixe de topic,
+ * sans recevoir les trames des autres collecteurs. Le payload est encodé
+ * directement dans un tampon d'un pool, transmis sans copie (zmq_msg_init_data)
+ * et rendu par ZeroMQ une fois le message envoyé.
+ */
 class ZmqExporter : public IExporter {
 public:
+    ~ZmqExporter() override;
+
     void configure(const nlohmann::json& config) override;
     bool connect() override;
     void disconnect() override;
     void export_data(const TelemetryData& data) override;
     bool is_connected() const override { return connected_; }
+
+    uint64_t dropped_messages() const { return dropped_; }
+
+    /**
+     * @brief Contexte ZeroMQ de l'exporter (nul hors connexion): un abonné du même
+     * processus doit l'utiliser pour se connecter à un endpoint inproc://.
+     */
+    void* zmq_context() const { return context_; }
+
 private:
-    std::unique_ptr<zmq::context_t> context_;
-    std::unique_ptr<zmq::socket_t> socket_;
-    bool connected_ = false;
-
-    std::string endpoint_;
-    std::string topic_;
-    int qos_ = 1; // Quality of Service level, if applicable
-    std::mutex connection_mutex_;
-    void sendMessage(const nlohmann::json& message);
-    void handleError(const std::string& errorMessage); 
+    class BufferPool;
+
+    /**
+     * @brief Tampon de payload prêté à ZeroMQ pendant l'envoi.
+     */
+    struct PooledBuffer {
+        BufferPool* pool;
+        std::string data;
+    };
+
+    /**
+     * @brief Tampons libérés, réutilisés pour conserver leur capacité.
+     *
+     * release() est appelé par les threads d'E/S de ZeroMQ.
+     */
+    class BufferPool {
+    public:
+        explicit BufferPool(size_t max_idle) : max_idle_(max_idle) {}
+        ~BufferPool();
+        PooledBuffer* acquire();
+        void release(PooledBuffer* buffer);
+    private:
+        std::mutex mutex_;
+        std::vector<PooledBuffer*> idle_;
+        size_t max_idle_;
+    };
+
+    static void releaseBuffer(void* data, void* hint);
+    void handleError(const std::string& errorMessage);
+
+    // Le pool doit survivre au contexte: zmq_ctx_term rend tous les tampons
+    std::unique_ptr<BufferPool> pool_;
+    void* context_ = nullptr;
+    void* socket_ = nullptr;
+    std::atomic<bool> connected_{false};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::string endpoint_ = "tcp://*:5556";
+    bool bind_ = true;                 // bind (serveur) ou connect (vers un proxy XSUB)
+    std::string topic_prefix_;
+    PayloadEncoding encoding_ = PayloadEncoding::JSON;
+    int send_hwm_ = 10000;             // Messages en file par abonné avant abandon
+    int linger_ms_ = 0;                // Attente des messages en file à la fermeture
+    int io_threads_ = 1;
+    size_t pool_size_ = 256;
+    std::mutex connection_mutex_;      // Les sockets ZeroMQ ne sont pas thread-safe
 };
 
 } // namespace exporters
-} // namespace modbustt
\ No newline at end of file
+} // namespace modbustt
@@ -14,13 +14,28 @@
 
 namespace modbustt {
 
-enum class CollectorCommand { PAUSE, RESUME, STOP, SET_FREQUENCY };
+enum class CollectorCommand { PAUSE, RESUME, STOP, SET_FREQUENCY, SET_REGISTERS };
 
 struct CollectorControlMessage {
     CollectorCommand command;
     int parameter = 0;
 };
 
+/**
+ * @brief Compteurs internes d'un collecteur (supervision de la collecte elle-même).
+ */
+struct CollectorStats {
+    uint64_t scans = 0;                 // Cycles de lecture effectués
+    uint64_t scan_errors = 0;           // Cycles en échec
+    uint64_t connect_failures = 0;
+    uint64_t reconnects = 0;            // Connexions rétablies après la première
+    double last_scan_duration_s = 0.0;  // Lecture des registres seule
+    double max_scan_duration_s = 0.0;
+    double last_export_duration_s = 0.0; // Appels export_data() des exporters du cycle
+    double max_export_duration_s = 0.0;
+    bool connected = false;
+};
+
 class ModbusCollector {
 public:
     ModbusCollector(const CollectorConfig& config);
@@ -34,17 +49,24 @@ public:
     void resume();
     void setFrequency(int frequencyMs);
 
+    /**
+     * @brief Remplace la liste des registres lus, entre deux cycles et sans reconnexion.
+     */
+    void setRegisters(const std::vector<RegisterConfig>& registers);
+    void setRegisters(std::shared_ptr<const RegisterTable> registers);
+
     void addExporter(std::shared_ptr<exporters::IExporter> exporter);
 
     bool isRunning() const { return running_; }
     bool isPaused() const { return paused_; }
     const std::string& getId() const { return config_.id; }
+    CollectorStats getStats() const;
 
 private:
     void threadFunction();
     bool connectToModbus();
     void disconnectFromModbus();
-    bool readRegisters();
+    bool readRegisters(std::map<std::string, double>& values);
     void processControlMessages();
     void exportData(const TelemetryData& data);
 
@@ -61,9 +83,22 @@ private:
     std::queue<CollectorControlMessage> controlQueue_;
     std::mutex controlMutex_;
     std::condition_variable controlCondition_;
+    std::shared_ptr<const RegisterTable> pendingRegisters_; // Appliqués par SET_REGISTERS
 
     std::vector<std::shared_ptr<exporters::IExporter>> exporters_;
     std::chrono::milliseconds acquisitionPeriod_;
+    std::shared_ptr<const RegisterTable> registers_; // Registres lus à chaque cycle (thread de collecte)
+
+    // Statistiques, écrites par le thread de collecte et lues par les exporters de métriques
+    std::atomic<uint64_t> scans_{0};
+    std::atomic<uint64_t> scanErrors_{0};
+    std::atomic<uint64_t> connectFailures_{0};
+    std::atomic<uint64_t> connections_{0};
+    std::atomic<uint64_t> lastScanDurationUs_{0};
+    std::atomic<uint64_t> maxScanDurationUs_{0};
+    std::atomic<uint64_t> lastExportDurationUs_{0};
+    std::atomic<uint64_t> maxExportDurationUs_{0};
+    std::atomic<bool> statsConnected_{false};
 };
 
 } // namespace modbustt
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace modbustt {
+namespace shm {
+
+/**
+ * @brief Disposition de la région de mémoire partagée de SharedMemoryExporter.
+ *
+ * La région est partagée entre un écrivain (le processus d'acquisition) et des
+ * lecteurs quelconques, sans verrou ni appel système côté lecteur:
+ *  - un en-tête décrivant les tailles et positions des tables;
+ *  - la table des collecteurs et la table des points, dont les noms sont
+ *    immuables une fois publiés (compteur incrémenté en release);
+ *  - la valeur courante de chaque point, protégée par un seqlock;
+ *  - un anneau de diffusion des trames complètes, chaque case protégée par un
+ *    seqlock. Les lecteurs suivent l'anneau avec leur propre curseur.
+ *
+ * Toute modification de cette disposition doit incrémenter kVersion.
+ */
+
+constexpr uint64_t kMagic = 0x314D48535454424DULL;    // "MBTTSHM1"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kIdLength = 32;      // Identifiant de collecteur, '\0' inclus
+constexpr size_t kNameLength = 64;    // Nom de point, '\0' inclus
+constexpr size_t kCacheLine = 64;
+
+enum WriterState : uint32_t {
+    WRITER_INITIALIZING = 0,
+    WRITER_LIVE = 1,
+    WRITER_CLOSED = 2     // L'écrivain s'est arrêté: les données ne seront plus mises à jour
+};
+
+struct alignas(kCacheLine) Header {
+    std::atomic<uint64_t> magic;          // Écrit en dernier à l'initialisation
+    uint32_t version;
+    uint32_t max_collectors;
+    uint32_t table_capacity;
+    uint32_t ring_capacity;
+    uint32_t ring_max_points;
+    uint32_t reserved;
+    uint64_t collectors_offset;
+    uint64_t table_offset;
+    uint64_t ring_offset;
+    uint64_t slot_stride;
+    uint64_t total_size;
+
+    alignas(kCacheLine) std::atomic<uint32_t> state;
+    std::atomic<uint32_t> collector_count;
+    std::atomic<uint32_t> entry_count;
+    std::atomic<uint64_t> ring_head;      // Curseur de la dernière trame publiée (0: aucune)
+};
+
+struct CollectorName {
+    char id[kIdLength];
+};
+
+/**
+ * @brief Point de la table des dernières valeurs.
+ *
+ * collector et point sont écrits avant la publication de l'entrée et ne
+ * changent plus; value_bits et timestamp_ns sont protégés par sequence.
+ */
+struct alignas(kCacheLine) Entry {
+    uint32_t collector;
+    char point[kNameLength];
+    std::atomic<uint64_t> sequence;       // Impair pendant une écriture
+    std::atomic<uint64_t> value_bits;     // double, représentation binaire
+    std::atomic<int64_t> timestamp_ns;    // Depuis l'epoch Unix
+};
+
+struct RingSlotHeader {
+    std::atomic<uint64_t> sequence;       // Impair pendant une écriture
+    std::atomic<uint64_t> cursor;
+    std::atomic<int64_t> timestamp_ns;
+    std::atomic<uint32_t> collector;
+    std::atomic<uint32_t> count;
+};
+
+struct RingValue {
+    std::atomic<uint32_t> entry;          // Index dans la table des points
+    uint32_t reserved;
+    std::atomic<uint64_t> value_bits;
+};
+
+// Les atomiques doivent être utilisables entre processus
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "32-bit atomics must be lock-free");
+static_assert(std::is_standard_layout<Header>::value, "Header must be standard layout");
+static_assert(std::is_standard_layout<Entry>::value, "Entry must be standard layout");
+
+inline uint64_t alignUp(uint64_t size, uint64_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+inline uint64_t slotStride(uint32_t ring_max_points) {
+    return alignUp(sizeof(RingSlotHeader) + static_cast<uint64_t>(ring_max_points) * sizeof(RingValue), kCacheLine);
+}
+
+} // namespace shm
+} // namespace modbustt
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "shm_layout.h"
+#include "telemetry_data.h"
+#include <string>
+#include <vector>
+
+namespace modbustt {
+
+/**
+ * @brief Résultat d'une lecture de l'anneau de diffusion.
+ */
+struct SharedMemoryReadResult {
+    std::vector<TelemetryData> frames;
+    uint64_t next_cursor = 0;   // À repasser au prochain appel de read_since()
+    uint64_t missed = 0;        // Trames écrasées avant d'avoir été lues
+};
+
+/**
+ * @brief Lecteur de la région publiée par SharedMemoryExporter.
+ *
+ * Toutes les lectures se font dans la projection mémoire, sans verrou ni appel
+ * système: find() résout une fois un point en handle, read() lit ensuite sa
+ * dernière valeur en quelques dizaines de nanosecondes. Un lecteur ne modifie
+ * jamais la région; plusieurs lecteurs (threads ou processus) sont indépendants.
+ *
+ * Ne dépend que de la bibliothèque standard (cible modbustt_shm).
+ */
+class SharedMemoryReader {
+public:
+    SharedMemoryReader() = default;
+    ~SharedMemoryReader();
+    SharedMemoryReader(const SharedMemoryReader&) = delete;
+    SharedMemoryReader& operator=(const SharedMemoryReader&) = delete;
+
+    bool open(const std::string& name = "/modbustt");
+    void close();
+    bool is_open() const { return header_ != nullptr; }
+
+    /**
+     * @brief true si l'écrivain s'est arrêté; rouvrir pour suivre une nouvelle instance.
+     */
+    bool writer_closed() const;
+
+    /**
+     * @brief Handle d'un point, ou -1 s'il n'a pas (encore) été publié.
+     */
+    int find(const std::string& collector_id, const std::string& point) const;
+
+    /**
+     * @brief Dernière valeur d'un point; false si le handle est invalide ou jamais écrit.
+     */
+    bool read(int handle, double& value, int64_t* timestamp_ns = nullptr) const;
+
+    /**
+     * @brief Dernières valeurs de tous les points, une trame par collecteur.
+     */
+    std::vector<TelemetryData> snapshot() const;
+
+    /**
+     * @brief Trames publiées après cursor (0: depuis la plus ancienne conservée).
+     */
+    SharedMemoryReadResult read_since(uint64_t cursor, size_t max_count = 0) const;
+
+    /**
+     * @brief Curseur de la dernière trame publiée.
+     */
+    uint64_t head() const;
+
+private:
+    const shm::Entry* entries() const;
+    const shm::CollectorName* collectorNames() const;
+    bool readSlot(uint64_t cursor, TelemetryData& frame) const;
+
+    const uint8_t* base_ = nullptr;
+    const shm::Header* header_ = nullptr;
+    size_t mapped_size_ = 0;
+};
+
+} // namespace modbustt
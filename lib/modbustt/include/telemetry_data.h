@@ -3,6 +3,8 @@
 #include <string>
 #include <map>
 #include <chrono>
+#include <array>
+#include <cstdint>
 
 namespace modbustt {
 
@@ -14,11 +16,18 @@ struct TelemetryData {
     std::chrono::system_clock::time_point timestamp; // Horodatage de l'acquisition
     std::map<std::string, double> values;         // Nom du point de donnée -> Valeur
 
+    // Encodages déjà produits pour cette trame, partagés par les exporters
+    // (voir exporters::encoded_frame). À vider si la trame est modifiée après export.
+    mutable std::array<std::string, 3> encoded;
+    mutable uint8_t encoded_mask = 0;
+
     TelemetryData() = default;
 
     TelemetryData(const std::string& id, const std::map<std::string, double>& data)
         : collector_id(id), timestamp(std::chrono::system_clock::now()), values(data) {
     }
+
+    void clear_encoded() const { encoded_mask = 0; }
 };
 
 } // namespace modbustt
\ No newline at end of file
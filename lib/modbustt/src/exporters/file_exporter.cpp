@@ -1,14 +1,33 @@
 #include "exporters/file_exporter.h"
 #include "Logger.h"
-#include <iomanip>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
 namespace modbustt {
 namespace exporters {
 
+namespace {
+
+// Délai entre deux tentatives d'ouverture du segment actif après un échec
+constexpr auto kReopenDelay = std::chrono::seconds(1);
+
+int syncData(int fd) {
+#ifdef __APPLE__
+    return ::fsync(fd); // fdatasync n'est pas exposé sur macOS
+#else
+    return ::fdatasync(fd);
+#endif
+}
+
+} // namespace
+
 FileExporter::~FileExporter() {
     disconnect();
 }
@@ -16,42 +35,324 @@ FileExporter::~FileExporter() {
 void FileExporter::configure(const nlohmann::json& config) {
     std::lock_guard<std::mutex> lock(mutex_);
     filepath_ = config.value("filepath", "modbustt_output.jsonl");
+    encoding_ = parse_encoding(config.value("encoding", "json"));
+
+    buffered_ = config.value("buffered", false);
+    buffer_size_ = config.value("buffer_size", static_cast<size_t>(1024 * 1024));
+    flush_interval_ms_ = std::max(1, config.value("flush_interval_ms", 1000));
+    fdatasync_ = config.value("fdatasync", false);
+
+    max_segment_bytes_ = config.value("max_segment_bytes", static_cast<size_t>(0));
+    max_segment_age_s_ = config.value("max_segment_age_s", 0);
+
+    // Compression par trame: implique le mode tamponné, une trame par lot écrit
+    compressor_.reset();
+    std::string compression = config.value("compression", "none");
+    if (compression != "none") {
+        compressor_ = make_frame_compressor(compression, config.value("compression_level", 0));
+        if (compressor_ && !buffered_) {
+            LOG_INFO("FileExporter: Compression enabled, switching to buffered mode");
+            buffered_ = true;
+        }
+        max_pending_chunks_ = std::max<size_t>(1, config.value("max_pending_chunks", static_cast<size_t>(64)));
+    }
+    active_path_ = filepath_ + (compressor_ ? compressor_->file_suffix() : "");
 }
 
 bool FileExporter::connect() {
+    {
+        std::lock_guard<std::mutex> io_lock(io_mutex_);
+        if (open_) return true;
+        if (!openSegment()) {
+            return false;
+        }
+        open_ = true;
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
-    file_stream_.open(filepath_, std::ios::app);
-    if (!file_stream_.is_open()) {
-        LOG_ERROR("FileExporter: Could not open file " + filepath_);
-        return false;
+    if (buffered_) {
+        buffer_.reserve(buffer_size_);
+    }
+    if (compressor_ && !compress_thread_) {
+        compress_stop_ = false;
+        compress_thread_ = std::make_unique<std::thread>(&FileExporter::compressionThreadFunction, this);
+    }
+    // Le thread de fond vide le tampon et gère la rotation par âge
+    if ((buffered_ || max_segment_age_s_ > 0) && !flush_thread_) {
+        flush_stop_ = false;
+        flush_thread_ = std::make_unique<std::thread>(&FileExporter::flushThreadFunction, this);
     }
-    LOG_INFO("FileExporter: Log file opened at " + filepath_);
     return true;
 }
 
 void FileExporter::disconnect() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (file_stream_.is_open()) {
-        file_stream_.close();
+    open_ = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_stop_ = true;
+    }
+    flush_cv_.notify_all();
+    if (flush_thread_ && flush_thread_->joinable()) {
+        flush_thread_->join();
     }
+    flush_thread_.reset();
+
+    flush();
+    stopCompressionThread(); // Vide la file de compression avant fermeture
+
+    std::lock_guard<std::mutex> io_lock(io_mutex_);
+    closeSegment();
 }
 
 void FileExporter::export_data(const TelemetryData& data) {
-    nlohmann::json j;
-    j["collector_id"] = data.collector_id;
-    
-    auto time_t = std::chrono::system_clock::to_time_t(data.timestamp);
-    std::stringstream ss;
-    ss << std::put_time(std::gmtime(&time_t), "%Y-%m-%dT%H:%M:%SZ");
-    j["timestamp"] = ss.str();
+    const std::string& payload = encoded_frame(data, encoding_);
 
-    j["values"] = data.values;
+    std::string record;
+    if (encoding_ == PayloadEncoding::JSON) {
+        record.reserve(payload.size() + 1);
+        record += payload;
+        record += '\n'; // JSON Lines format is great for logs
+    } else {
+        // Enregistrements binaires préfixés par leur longueur
+        record.reserve(payload.size() + 4);
+        append_length_prefix(record, payload.size());
+        record += payload;
+    }
 
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (file_stream_.is_open()) {
-        file_stream_ << j.dump() << std::endl; // JSON Lines format is great for logs
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!open_) return;
+
+    if (!buffered_) {
+        // Verrou d'E/S pris avant de relâcher mutex_ pour conserver l'ordre des enregistrements
+        std::lock_guard<std::mutex> io_lock(io_mutex_);
+        lock.unlock();
+        writeChunk(record);
+        return;
+    }
+
+    buffer_ += record;
+    if (buffer_.size() >= buffer_size_) {
+        std::string pending;
+        pending.reserve(buffer_size_);
+        pending.swap(buffer_);
+        std::lock_guard<std::mutex> io_lock(io_mutex_);
+        lock.unlock();
+        submitChunk(pending);
+    }
+}
+
+void FileExporter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::string pending;
+    pending.reserve(buffer_size_);
+    pending.swap(buffer_);
+    std::lock_guard<std::mutex> io_lock(io_mutex_);
+    lock.unlock();
+
+    if (!pending.empty()) {
+        submitChunk(pending);
+    }
+    if (segmentExpired()) {
+        rotateSegment();
+    }
+}
+
+void FileExporter::flushThreadFunction() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto period = std::chrono::milliseconds(buffered_ ? flush_interval_ms_ : 1000);
+    while (!flush_stop_) {
+        flush_cv_.wait_for(lock, period, [this] { return flush_stop_; });
+        if (flush_stop_) break;
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void FileExporter::submitChunk(std::string& pending) {
+    // Appelée avec io_mutex_ verrouillé
+    if (!compressor_) {
+        writeChunk(pending);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(compress_mutex_);
+        if (compress_queue_.size() >= max_pending_chunks_) {
+            // Compression trop lente: le lot est perdu plutôt que de bloquer les collecteurs
+            dropped_chunks_++;
+            LOG_ERROR("FileExporter: Compression backlog full, chunk dropped (" + std::to_string(dropped_chunks_) + " total)");
+            return;
+        }
+        compress_queue_.push_back(std::move(pending));
+    }
+    compress_cv_.notify_one();
+}
+
+void FileExporter::compressionThreadFunction() {
+    std::string chunk;
+    std::string frame;
+    std::unique_lock<std::mutex> lock(compress_mutex_);
+    while (true) {
+        compress_cv_.wait(lock, [this] { return compress_stop_ || !compress_queue_.empty(); });
+        if (compress_queue_.empty()) {
+            break; // Arrêt demandé et file vidée
+        }
+        chunk = std::move(compress_queue_.front());
+        compress_queue_.pop_front();
+        lock.unlock();
+
+        if (compressor_->compress_frame(chunk, frame)) {
+            std::lock_guard<std::mutex> io_lock(io_mutex_);
+            writeChunk(frame);
+        }
+        lock.lock();
+    }
+}
+
+void FileExporter::stopCompressionThread() {
+    if (!compress_thread_) return;
+    {
+        std::lock_guard<std::mutex> lock(compress_mutex_);
+        compress_stop_ = true;
+    }
+    compress_cv_.notify_all();
+    if (compress_thread_->joinable()) {
+        compress_thread_->join();
+    }
+    compress_thread_.reset();
+}
+
+void FileExporter::writeChunk(const std::string& chunk) {
+    // Appelée avec io_mutex_ verrouillé
+    if (chunk.empty()) return;
+    if (fd_ < 0 && !reopenSegment()) {
+        lost_chunks_++;
+        LOG_ERROR("FileExporter: No open segment, chunk dropped (" + std::to_string(lost_chunks_) + " total)");
+        return;
+    }
+
+    if (!writeAll(chunk.data(), chunk.size())) {
+        LOG_ERROR("FileExporter: Write failed on " + active_path_ + ": " + std::string(strerror(errno)));
+        return;
+    }
+    segment_bytes_ += chunk.size();
+
+    // Validation groupée: un seul fdatasync pour tout le lot
+    if (fdatasync_ && syncData(fd_) != 0) {
+        LOG_ERROR("FileExporter: fdatasync failed on " + active_path_ + ": " + std::string(strerror(errno)));
+    }
+
+    if ((max_segment_bytes_ > 0 && segment_bytes_ >= max_segment_bytes_) || segmentExpired()) {
+        rotateSegment();
+    }
+}
+
+bool FileExporter::writeAll(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool FileExporter::segmentExpired() const {
+    if (max_segment_age_s_ <= 0 || segment_bytes_ == 0) return false;
+    return std::chrono::steady_clock::now() - segment_opened_at_ >= std::chrono::seconds(max_segment_age_s_);
+}
+
+bool FileExporter::openSegment() {
+    // Appelée avec io_mutex_ verrouillé
+    int fd = ::open(active_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("FileExporter: Could not open file " + active_path_);
+        return false;
+    }
+
+    struct stat st;
+    segment_bytes_ = (fstat(fd, &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+    segment_opened_at_ = std::chrono::steady_clock::now();
+    fd_ = fd;
+    LOG_INFO("FileExporter: Log file opened at " + active_path_);
+    return true;
+}
+
+bool FileExporter::reopenSegment() {
+    // Appelée avec io_mutex_ verrouillé, au plus une tentative par kReopenDelay
+    auto now = std::chrono::steady_clock::now();
+    if (now < next_reopen_) return false;
+    if (openSegment()) return true;
+    next_reopen_ = now + kReopenDelay;
+    return false;
+}
+
+void FileExporter::closeSegment() {
+    // Appelée avec io_mutex_ verrouillé
+    if (fd_ >= 0) {
+        if (fdatasync_) {
+            syncData(fd_);
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void FileExporter::rotateSegment() {
+    // Appelée avec io_mutex_ verrouillé. Le nouveau segment est ouvert avant la
+    // fermeture de l'ancien: fd_ reste valide pendant toute la rotation
+    std::string target = rotatedSegmentPath();
+    if (fdatasync_) {
+        syncData(fd_);
+    }
+
+    // rename() est atomique: les consommateurs ne voient que des segments complets
+    if (::rename(active_path_.c_str(), target.c_str()) != 0) {
+        LOG_ERROR("FileExporter: Could not rotate " + active_path_ + " to " + target + ": " + std::string(strerror(errno)));
+        return; // L'écriture continue dans le segment actif
+    }
+    LOG_INFO("FileExporter: Segment rotated to " + target);
+
+    int previous = fd_;
+    if (!openSegment()) {
+        // Le segment renommé est clos; l'ouverture est retentée aux écritures suivantes
+        ::close(previous);
+        fd_ = -1;
+        next_reopen_ = std::chrono::steady_clock::now() + kReopenDelay;
+        return;
+    }
+    ::close(previous);
+}
+
+std::string FileExporter::rotatedSegmentPath() const {
+    // telemetry.jsonl(.zst) -> telemetry.20250713T120000Z.jsonl(.zst)
+    std::string stem = filepath_;
+    std::string extension;
+    size_t dot = filepath_.find_last_of('.');
+    size_t slash = filepath_.find_last_of('/');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+        stem = filepath_.substr(0, dot);
+        extension = filepath_.substr(dot);
+    }
+
+    std::time_t now = std::time(nullptr);
+    std::tm tm_utc;
+    gmtime_r(&now, &tm_utc);
+    char suffix[32];
+    std::strftime(suffix, sizeof(suffix), "%Y%m%dT%H%M%SZ", &tm_utc);
+
+    extension += active_path_.substr(filepath_.size());
+    std::string candidate = stem + "." + suffix + extension;
+    struct stat st;
+    for (int n = 1; ::stat(candidate.c_str(), &st) == 0; ++n) {
+        candidate = stem + "." + suffix + "-" + std::to_string(n) + extension;
     }
+    return candidate;
 }
 
 } // namespace exporters
-} // namespace modbustt
\ No newline at end of file
+} // namespace modbustt
@@ -0,0 +1,109 @@
+#include "exporters/frame_compressor.h"
+#include "Logger.h"
+#include <cstring>
+
+#ifdef MODBUSTT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef MODBUSTT_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace modbustt {
+namespace exporters {
+
+namespace {
+
+#ifdef MODBUSTT_HAVE_ZLIB
+class GzipCompressor : public FrameCompressor {
+public:
+    explicit GzipCompressor(int level) {
+        std::memset(&stream_, 0, sizeof(stream_));
+        // windowBits 15 + 16: en-tête et somme de contrôle gzip
+        initialized_ = deflateInit2(&stream_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~GzipCompressor() override {
+        if (initialized_) deflateEnd(&stream_);
+    }
+
+    bool compress_frame(const std::string& input, std::string& output) override {
+        if (!initialized_) return false;
+
+        output.resize(deflateBound(&stream_, input.size()) + 32);
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+        stream_.next_out = reinterpret_cast<Bytef*>(&output[0]);
+        stream_.avail_out = static_cast<uInt>(output.size());
+
+        int rc = deflate(&stream_, Z_FINISH);
+        size_t produced = output.size() - stream_.avail_out;
+        deflateReset(&stream_); // Nouveau membre gzip pour la trame suivante
+
+        if (rc != Z_STREAM_END) {
+            LOG_ERROR("FrameCompressor: gzip compression failed (" + std::to_string(rc) + ")");
+            return false;
+        }
+        output.resize(produced);
+        return true;
+    }
+
+    const char* file_suffix() const override { return ".gz"; }
+
+private:
+    z_stream stream_;
+    bool initialized_ = false;
+};
+#endif
+
+#ifdef MODBUSTT_HAVE_ZSTD
+class ZstdCompressor : public FrameCompressor {
+public:
+    explicit ZstdCompressor(int level) : context_(ZSTD_createCCtx()), level_(level) {}
+
+    ~ZstdCompressor() override {
+        ZSTD_freeCCtx(context_);
+    }
+
+    bool compress_frame(const std::string& input, std::string& output) override {
+        if (!context_) return false;
+
+        output.resize(ZSTD_compressBound(input.size()));
+        size_t produced = ZSTD_compressCCtx(context_, &output[0], output.size(),
+                                            input.data(), input.size(), level_);
+        if (ZSTD_isError(produced)) {
+            LOG_ERROR("FrameCompressor: zstd compression failed: " + std::string(ZSTD_getErrorName(produced)));
+            return false;
+        }
+        output.resize(produced);
+        return true;
+    }
+
+    const char* file_suffix() const override { return ".zst"; }
+
+private:
+    ZSTD_CCtx* context_;
+    int level_;
+};
+#endif
+
+} // namespace
+
+std::unique_ptr<FrameCompressor> make_frame_compressor(const std::string& algorithm, int level) {
+#ifdef MODBUSTT_HAVE_ZLIB
+    if (algorithm == "gzip") {
+        return std::make_unique<GzipCompressor>(level > 0 ? level : Z_DEFAULT_COMPRESSION);
+    }
+#endif
+#ifdef MODBUSTT_HAVE_ZSTD
+    if (algorithm == "zstd") {
+        return std::make_unique<ZstdCompressor>(level > 0 ? level : 3);
+    }
+#endif
+    (void)level;
+    LOG_ERROR("FrameCompressor: Compression '" + algorithm + "' unknown or not available in this build");
+    return nullptr;
+}
+
+} // namespace exporters
+} // namespace modbustt
@@ -0,0 +1,185 @@
+#include "exporters/gorilla_codec.h"
+#include <cstring>
+
+namespace modbustt {
+namespace exporters {
+
+namespace {
+
+uint64_t double_to_bits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bits_to_double(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int leading_zeros(uint64_t value) {
+    return value == 0 ? 64 : __builtin_clzll(value);
+}
+
+int trailing_zeros(uint64_t value) {
+    return value == 0 ? 64 : __builtin_ctzll(value);
+}
+
+} // namespace
+
+void GorillaEncoder::write_bits(uint64_t value, int bits) {
+    while (bits > 0) {
+        if (bit_pos_ == 0) {
+            bytes_.push_back('\0');
+        }
+        int free_bits = 8 - bit_pos_;
+        int take = bits < free_bits ? bits : free_bits;
+        uint8_t chunk = static_cast<uint8_t>((value >> (bits - take)) & ((1u << take) - 1));
+        bytes_.back() = static_cast<char>(static_cast<uint8_t>(bytes_.back()) | (chunk << (free_bits - take)));
+        bits -= take;
+        bit_pos_ = (bit_pos_ + take) % 8;
+    }
+}
+
+void GorillaEncoder::append(int64_t timestamp_ms, double value) {
+    uint64_t value_bits = double_to_bits(value);
+
+    if (count_ == 0) {
+        write_bits(static_cast<uint64_t>(timestamp_ms), 64);
+        write_bits(value_bits, 64);
+        first_timestamp_ = timestamp_ms;
+        prev_timestamp_ = timestamp_ms;
+        prev_value_bits_ = value_bits;
+        count_ = 1;
+        return;
+    }
+
+    // Horodatage: delta-of-delta sur des plages de taille croissante
+    int64_t delta = timestamp_ms - prev_timestamp_;
+    int64_t dod = delta - prev_delta_;
+    if (dod == 0) {
+        write_bits(0b0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        write_bits(0b10, 2);
+        write_bits(static_cast<uint64_t>(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        write_bits(0b110, 3);
+        write_bits(static_cast<uint64_t>(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        write_bits(0b1110, 4);
+        write_bits(static_cast<uint64_t>(dod + 2047), 12);
+    } else {
+        write_bits(0b1111, 4);
+        write_bits(static_cast<uint64_t>(dod), 64);
+    }
+    prev_delta_ = delta;
+    prev_timestamp_ = timestamp_ms;
+
+    // Valeur: XOR avec la précédente, seuls les bits significatifs sont stockés
+    uint64_t xored = value_bits ^ prev_value_bits_;
+    if (xored == 0) {
+        write_bits(0b0, 1);
+    } else {
+        int leading = leading_zeros(xored);
+        int trailing = trailing_zeros(xored);
+        if (leading > 31) leading = 31; // Codé sur 5 bits
+
+        if (prev_leading_ >= 0 && leading >= prev_leading_ && trailing >= prev_trailing_) {
+            // La fenêtre significative précédente suffit
+            int meaningful = 64 - prev_leading_ - prev_trailing_;
+            write_bits(0b10, 2);
+            write_bits(xored >> prev_trailing_, meaningful);
+        } else {
+            int meaningful = 64 - leading - trailing;
+            write_bits(0b11, 2);
+            write_bits(static_cast<uint64_t>(leading), 5);
+            write_bits(static_cast<uint64_t>(meaningful - 1), 6); // 1..64 codé sur 0..63
+            write_bits(xored >> trailing, meaningful);
+            prev_leading_ = leading;
+            prev_trailing_ = trailing;
+        }
+    }
+    prev_value_bits_ = value_bits;
+    count_++;
+}
+
+GorillaDecoder::GorillaDecoder(const char* data, size_t size, size_t count)
+    : data_(reinterpret_cast<const unsigned char*>(data)), size_bits_(size * 8), remaining_(count) {}
+
+bool GorillaDecoder::read_bit(bool& bit) {
+    if (pos_ >= size_bits_) return false;
+    bit = (data_[pos_ / 8] >> (7 - pos_ % 8)) & 1;
+    pos_++;
+    return true;
+}
+
+bool GorillaDecoder::read_bits(int bits, uint64_t& value) {
+    if (pos_ + static_cast<size_t>(bits) > size_bits_) return false;
+    value = 0;
+    while (bits > 0) {
+        int offset = static_cast<int>(pos_ % 8);
+        int available = 8 - offset;
+        int take = bits < available ? bits : available;
+        uint64_t chunk = (data_[pos_ / 8] >> (available - take)) & ((1u << take) - 1);
+        value = (value << take) | chunk;
+        pos_ += static_cast<size_t>(take);
+        bits -= take;
+    }
+    return true;
+}
+
+bool GorillaDecoder::next(int64_t& timestamp_ms, double& value) {
+    if (remaining_ == 0) return false;
+
+    uint64_t raw;
+    if (index_ == 0) {
+        if (!read_bits(64, raw)) return false;
+        prev_timestamp_ = static_cast<int64_t>(raw);
+        if (!read_bits(64, prev_value_bits_)) return false;
+    } else {
+        // Préfixe unaire de la plage du delta-of-delta
+        int ones = 0;
+        bool bit = true;
+        while (ones < 4) {
+            if (!read_bit(bit)) return false;
+            if (!bit) break;
+            ones++;
+        }
+
+        int64_t dod = 0;
+        switch (ones) {
+            case 0: break;
+            case 1: if (!read_bits(7, raw)) return false; dod = static_cast<int64_t>(raw) - 63; break;
+            case 2: if (!read_bits(9, raw)) return false; dod = static_cast<int64_t>(raw) - 255; break;
+            case 3: if (!read_bits(12, raw)) return false; dod = static_cast<int64_t>(raw) - 2047; break;
+            default: if (!read_bits(64, raw)) return false; dod = static_cast<int64_t>(raw); break;
+        }
+        prev_delta_ += dod;
+        prev_timestamp_ += prev_delta_;
+
+        if (!read_bit(bit)) return false;
+        if (bit) {
+            bool new_window;
+            if (!read_bit(new_window)) return false;
+            if (new_window) {
+                uint64_t leading, meaningful;
+                if (!read_bits(5, leading) || !read_bits(6, meaningful)) return false;
+                prev_leading_ = static_cast<int>(leading);
+                prev_trailing_ = 64 - prev_leading_ - static_cast<int>(meaningful + 1);
+            }
+            int meaningful = 64 - prev_leading_ - prev_trailing_;
+            if (!read_bits(meaningful, raw)) return false;
+            prev_value_bits_ ^= raw << prev_trailing_;
+        }
+    }
+
+    timestamp_ms = prev_timestamp_;
+    value = bits_to_double(prev_value_bits_);
+    index_++;
+    remaining_--;
+    return true;
+}
+
+} // namespace exporters
+} // namespace modbustt
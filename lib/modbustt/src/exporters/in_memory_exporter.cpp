@@ -1,32 +1,344 @@
 #include "exporters/in_memory_exporter.h"
+#include "Logger.h"
+#include <algorithm>
 
 namespace modbustt {
 namespace exporters {
 
+namespace {
+
+// Tentatives de relecture d'une case avant de la considérer comme écrasée
+constexpr int kMaxReadRetries = 64;
+
+bool sameNames(const std::vector<std::string>& names, const TelemetryData& data, size_t max_points) {
+    return names.size() == std::min(data.values.size(), max_points) &&
+           std::equal(names.begin(), names.end(), data.values.begin(),
+                      [](const std::string& name, const std::pair<const std::string, double>& pair) {
+                          return name == pair.first;
+                      });
+}
+
+/**
+ * Lecture en cours sur un anneau: l'écrivain ne libère aucun schéma remplacé
+ * tant que le compteur n'est pas nul.
+ */
+class ReadGuard {
+public:
+    explicit ReadGuard(std::atomic<uint32_t>& readers) : readers_(readers) { readers_.fetch_add(1); }
+    ~ReadGuard() { readers_.fetch_sub(1); }
+
+private:
+    std::atomic<uint32_t>& readers_;
+};
+
+} // namespace
+
+InMemoryExporter::Ring::Ring(const std::string& id, size_t ring_capacity, size_t ring_max_points)
+    : collector_id(id), capacity(ring_capacity), max_points(ring_max_points),
+      slots(new Slot[ring_capacity]), values(new std::atomic<double>[ring_capacity * ring_max_points]) {
+    for (auto& schema : schemas) {
+        schema.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+InMemoryExporter::Ring::~Ring() {
+    for (auto& schema : schemas) {
+        delete schema.load(std::memory_order_relaxed);
+    }
+    for (const Schema* schema : retired) {
+        delete schema;
+    }
+}
+
+InMemoryExporter::InMemoryExporter() {
+    rings_.reset(new std::atomic<Ring*>[max_collectors_]);
+    for (size_t i = 0; i < max_collectors_; ++i) {
+        rings_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+InMemoryExporter::~InMemoryExporter() = default;
+
 void InMemoryExporter::configure(const nlohmann::json& config) {
     std::lock_guard<std::mutex> lock(mutex_);
-    max_size_ = config.value("max_size", 1000);
+    // "max_size" (ancien nom) est désormais une capacité par collecteur
+    capacity_ = std::max<size_t>(1, config.value("capacity", config.value("max_size", static_cast<size_t>(1000))));
+    max_points_ = std::max<size_t>(1, config.value("max_points", static_cast<size_t>(64)));
+    max_collectors_ = std::max<size_t>(1, config.value("max_collectors", static_cast<size_t>(64)));
+
+    ring_count_.store(0, std::memory_order_release);
+    rings_.reset(new std::atomic<Ring*>[max_collectors_]);
+    for (size_t i = 0; i < max_collectors_; ++i) {
+        rings_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    owned_rings_.clear();
 }
 
 void InMemoryExporter::export_data(const TelemetryData& data) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (data_queue_.size() >= max_size_) {
-        data_queue_.pop_front();
+    Ring* ring = findOrCreateRing(data.collector_id);
+    if (!ring) return;
+
+    std::lock_guard<std::mutex> writer_lock(ring->writer_mutex);
+    uint64_t cursor = ring->head.load(std::memory_order_relaxed) + 1;
+    uint32_t schema = schemaFor(*ring, data, cursor);
+
+    size_t index = static_cast<size_t>(cursor % ring->capacity);
+    Slot& slot = ring->slots[index];
+
+    // Seqlock: séquence impaire pendant l'écriture
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.cursor.store(cursor, std::memory_order_relaxed);
+    slot.timestamp_ms.store(std::chrono::duration_cast<std::chrono::milliseconds>(
+        data.timestamp.time_since_epoch()).count(), std::memory_order_relaxed);
+    slot.schema.store(schema, std::memory_order_relaxed);
+    std::atomic<double>* values = &ring->values[index * ring->max_points];
+    size_t count = 0;
+    for (const auto& pair : data.values) {
+        if (count == ring->max_points) break;
+        values[count++].store(pair.second, std::memory_order_relaxed);
+    }
+    slot.count.store(static_cast<uint32_t>(count), std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    ring->head.store(cursor, std::memory_order_release);
+}
+
+std::vector<std::string> InMemoryExporter::collectors() const {
+    std::vector<std::string> ids;
+    size_t count = ring_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        Ring* ring = rings_[i].load(std::memory_order_acquire);
+        if (ring) ids.push_back(ring->collector_id);
     }
-    data_queue_.push_back(data);
+    return ids;
+}
+
+std::vector<TelemetryEntry> InMemoryExporter::latest(const std::string& collector_id, size_t count) const {
+    std::vector<TelemetryEntry> entries;
+    Ring* ring = findRing(collector_id);
+    if (!ring || count == 0) return entries;
+
+    ReadGuard guard(ring->readers);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t first = head > count ? head - count + 1 : 1;
+    TelemetryEntry entry;
+    for (uint64_t cursor = first; cursor <= head; ++cursor) {
+        if (readSlot(*ring, cursor, entry)) entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+std::vector<TelemetryEntry> InMemoryExporter::range(const std::string& collector_id,
+                                                    std::chrono::system_clock::time_point from,
+                                                    std::chrono::system_clock::time_point to) const {
+    std::vector<TelemetryEntry> entries;
+    Ring* ring = findRing(collector_id);
+    if (!ring) return entries;
+
+    ReadGuard guard(ring->readers);
+    // Parcours du plus récent au plus ancien; les horodatages d'un collecteur sont croissants
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t oldest = head >= ring->capacity ? head - ring->capacity + 1 : 1;
+    TelemetryEntry entry;
+    for (uint64_t cursor = head; cursor >= oldest && cursor > 0; --cursor) {
+        if (!readSlot(*ring, cursor, entry)) break;
+        if (entry.data.timestamp < from) break;
+        if (entry.data.timestamp <= to) entries.push_back(std::move(entry));
+    }
+    std::reverse(entries.begin(), entries.end());
+    return entries;
+}
+
+TelemetryReadResult InMemoryExporter::read_since(const std::string& collector_id, uint64_t cursor,
+                                                 size_t max_count) const {
+    TelemetryReadResult result;
+    result.next_cursor = cursor;
+    Ring* ring = findRing(collector_id);
+    if (!ring) return result;
+
+    ReadGuard guard(ring->readers);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t oldest = head >= ring->capacity ? head - ring->capacity + 1 : 1;
+    uint64_t next = cursor + 1;
+    if (next < oldest) {
+        result.missed = oldest - next;
+        next = oldest;
+    }
+
+    TelemetryEntry entry;
+    for (; next <= head; ++next) {
+        if (max_count > 0 && result.entries.size() >= max_count) break;
+        if (readSlot(*ring, next, entry)) {
+            result.entries.push_back(std::move(entry));
+        } else {
+            result.missed++; // Écrasée pendant la lecture
+        }
+        result.next_cursor = next;
+    }
+    return result;
 }
 
 std::deque<TelemetryData> InMemoryExporter::flush() {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::deque<TelemetryData> flushed_data;
-    data_queue_.swap(flushed_data);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& ring : owned_rings_) {
+        TelemetryReadResult result = read_since(ring->collector_id, ring->flush_cursor);
+        for (auto& entry : result.entries) {
+            flushed_data.push_back(std::move(entry.data));
+        }
+        ring->flush_cursor = result.next_cursor;
+    }
     return flushed_data;
 }
 
 size_t InMemoryExporter::size() const {
+    size_t total = 0;
+    size_t count = ring_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        Ring* ring = rings_[i].load(std::memory_order_acquire);
+        if (ring) total += static_cast<size_t>(std::min<uint64_t>(ring->head.load(std::memory_order_acquire),
+                                                                  ring->capacity));
+    }
+    return total;
+}
+
+InMemoryExporter::Ring* InMemoryExporter::findRing(const std::string& collector_id) const {
+    size_t count = ring_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        Ring* ring = rings_[i].load(std::memory_order_acquire);
+        if (ring && ring->collector_id == collector_id) return ring;
+    }
+    return nullptr;
+}
+
+InMemoryExporter::Ring* InMemoryExporter::findOrCreateRing(const std::string& collector_id) {
+    Ring* ring = findRing(collector_id);
+    if (ring) return ring;
+
     std::lock_guard<std::mutex> lock(mutex_);
-    return data_queue_.size();
+    ring = findRing(collector_id);
+    if (ring) return ring;
+
+    size_t count = ring_count_.load(std::memory_order_relaxed);
+    if (count >= max_collectors_) {
+        LOG_ERROR("InMemoryExporter: max_collectors reached, data of '" + collector_id + "' is not kept");
+        return nullptr;
+    }
+    owned_rings_.push_back(std::make_unique<Ring>(collector_id, capacity_, max_points_));
+    ring = owned_rings_.back().get();
+    rings_[count].store(ring, std::memory_order_release);
+    ring_count_.store(count + 1, std::memory_order_release);
+    return ring;
+}
+
+uint32_t InMemoryExporter::schemaFor(Ring& ring, const TelemetryData& data, uint64_t cursor) {
+    // Appelée par l'écrivain de l'anneau, le plus souvent avec le jeu de points courant
+    uint32_t index = ring.current_schema;
+    if (ring.schema_count == 0 ||
+        !sameNames(ring.schemas[index].load(std::memory_order_relaxed)->names, data, ring.max_points)) {
+        index = changeSchema(ring, data, cursor);
+        ring.current_schema = index;
+    }
+    ring.schema_last_cursor[index] = cursor;
+    return ring.schemas[index].load(std::memory_order_relaxed)->tag;
+}
+
+uint32_t InMemoryExporter::changeSchema(Ring& ring, const TelemetryData& data, uint64_t cursor) {
+    // Jeu de points déjà vu (points qui alternent): son schéma est repris tel quel
+    for (uint32_t i = 0; i < ring.schema_count; ++i) {
+        if (sameNames(ring.schemas[i].load(std::memory_order_relaxed)->names, data, ring.max_points)) return i;
+    }
+
+    // Table pleine: remplacer le schéma utilisé le moins récemment
+    uint32_t index = ring.schema_count;
+    if (index == kMaxSchemas) {
+        index = 0;
+        for (uint32_t i = 1; i < kMaxSchemas; ++i) {
+            if (ring.schema_last_cursor[i] < ring.schema_last_cursor[index]) index = i;
+        }
+        if (ring.schema_last_cursor[index] + ring.capacity >= cursor && !ring.schemas_exhausted_warned) {
+            // Des cases le référencent encore: leurs trames deviennent illisibles
+            ring.schemas_exhausted_warned = true;
+            LOG_WARN("InMemoryExporter: Point set of '" + ring.collector_id + "' changes too often (more than " +
+                     std::to_string(kMaxSchemas) + " point sets in the ring), older frames lost");
+        }
+    }
+    if (data.values.size() > ring.max_points && !ring.truncation_warned) {
+        ring.truncation_warned = true;
+        LOG_WARN("InMemoryExporter: '" + ring.collector_id + "' has more than max_points values, extra points not kept");
+    }
+
+    auto* schema = new Schema();
+    for (const auto& pair : data.values) {
+        if (schema->names.size() == ring.max_points) break;
+        schema->names.push_back(pair.first);
+    }
+    const Schema* replaced = ring.schemas[index].load(std::memory_order_relaxed);
+    schema->tag = replaced ? replaced->tag + static_cast<uint32_t>(kMaxSchemas) : index;
+    const Schema* previous = ring.schemas[index].exchange(schema);
+    if (index == ring.schema_count) ring.schema_count++;
+    if (previous) ring.retired.push_back(previous);
+
+    // Un lecteur entré après l'échange ne voit plus les schémas remplacés
+    if (!ring.retired.empty() && ring.readers.load() == 0) {
+        for (const Schema* retired : ring.retired) {
+            delete retired;
+        }
+        ring.retired.clear();
+    }
+    return index;
+}
+
+bool InMemoryExporter::readSlot(const Ring& ring, uint64_t cursor, TelemetryEntry& entry) {
+    size_t index = static_cast<size_t>(cursor % ring.capacity);
+    const Slot& slot = ring.slots[index];
+    const std::atomic<double>* values = &ring.values[index * ring.max_points];
+    double copy[256];
+    std::vector<double> large;
+
+    for (int attempt = 0; attempt < kMaxReadRetries; ++attempt) {
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) continue; // Écriture en cours
+
+        if (slot.cursor.load(std::memory_order_relaxed) != cursor) {
+            // Case déjà réutilisée par une trame plus récente (ou pas encore écrite)
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) return false;
+            continue;
+        }
+        int64_t timestamp_ms = slot.timestamp_ms.load(std::memory_order_relaxed);
+        uint32_t schema_tag = slot.schema.load(std::memory_order_relaxed);
+        uint32_t count = slot.count.load(std::memory_order_relaxed);
+        double* target = copy;
+        if (count > 256) {
+            large.resize(count);
+            target = large.data();
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            target[i] = values[i].load(std::memory_order_relaxed);
+        }
+        // Non libéré tant que ring.readers est non nul; son tag révèle un remplacement
+        const Schema* schema = ring.schemas[schema_tag % kMaxSchemas].load();
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+        if (schema->tag != schema_tag) return false; // Schéma remplacé: noms des points perdus
+
+        // Copie cohérente: reconstruire la trame hors de la section critique
+        entry.cursor = cursor;
+        entry.data.collector_id = ring.collector_id;
+        entry.data.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(timestamp_ms));
+        entry.data.values.clear();
+        for (uint32_t i = 0; i < count && i < schema->names.size(); ++i) {
+            entry.data.values.emplace_hint(entry.data.values.end(), schema->names[i], target[i]);
+        }
+        return true;
+    }
+    return false;
 }
 
 } // namespace exporters
-} // namespace modbustt
\ No newline at end of file
+} // namespace modbustt
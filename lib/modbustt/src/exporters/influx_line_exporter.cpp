@@ -0,0 +1,322 @@
+#include "exporters/influx_line_exporter.h"
+#include "Logger.h"
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <string.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace modbustt {
+namespace exporters {
+
+namespace {
+
+/**
+ * @brief Ajoute un identifiant échappé selon les règles du line protocol.
+ *
+ * Virgules et espaces sont échappés partout, '=' dans les clés et valeurs de
+ * tags et les clés de champs. Les retours à la ligne sont interdits: remplacés par un espace échappé.
+ */
+void appendEscaped(std::string& out, const std::string& value, bool escape_equals) {
+    for (char c : value) {
+        if (c == ',' || c == ' ' || (escape_equals && c == '=')) {
+            out += '\\';
+        } else if (c == '\n' || c == '\r') {
+            out += "\\ ";
+            continue;
+        }
+        out += c;
+    }
+}
+
+void appendInteger(std::string& out, int64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, static_cast<size_t>(result.ptr - buffer));
+}
+
+void appendDouble(std::string& out, double value) {
+    char buffer[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // Représentation la plus courte relisible à l'identique
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, static_cast<size_t>(result.ptr - buffer));
+#else
+    int length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    out.append(buffer, static_cast<size_t>(length));
+#endif
+}
+
+} // namespace
+
+InfluxLineExporter::~InfluxLineExporter() {
+    disconnect();
+}
+
+void InfluxLineExporter::configure(const nlohmann::json& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string protocol = config.value("protocol", "udp");
+    if (protocol != "udp" && protocol != "tcp") {
+        LOG_WARN("InfluxLineExporter: Unknown protocol '" + protocol + "', using udp");
+        protocol = "udp";
+    }
+    udp_ = (protocol == "udp");
+    host_ = config.value("host", "127.0.0.1");
+    port_ = config.value("port", udp_ ? 8089 : 8094);
+    measurement_ = config.value("measurement", "modbus");
+    // 1400 octets: un datagramme tient dans une trame Ethernet (MTU 1500) avec les en-têtes IP/UDP
+    max_batch_bytes_ = config.value("max_batch_bytes", static_cast<size_t>(udp_ ? 1400 : 64 * 1024));
+    flush_interval_ms_ = std::max(1, config.value("flush_interval_ms", 100));
+    max_pending_batches_ = std::max<size_t>(1, config.value("max_pending_batches", static_cast<size_t>(256)));
+    reconnect_interval_ms_ = config.value("reconnect_interval_ms", 1000);
+    prefixes_.clear();
+    batch_.reserve(max_batch_bytes_);
+}
+
+bool InfluxLineExporter::connect() {
+    if (sender_thread_) return connected_;
+
+    bool ok = openSocket();
+    connected_ = ok;
+    next_reconnect_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(reconnect_interval_ms_);
+
+    stop_ = false;
+    sender_thread_ = std::make_unique<std::thread>(&InfluxLineExporter::senderThreadFunction, this);
+    return ok;
+}
+
+void InfluxLineExporter::disconnect() {
+    if (sender_thread_) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (sender_thread_->joinable()) {
+            sender_thread_->join();
+        }
+        sender_thread_.reset();
+    }
+    closeSocket();
+    connected_ = false;
+}
+
+void InfluxLineExporter::export_data(const TelemetryData& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!sender_thread_) return;
+
+    line_.clear();
+    if (!render_line(data, line_)) return;
+
+    if (!batch_.empty() && batch_.size() + line_.size() > max_batch_bytes_) {
+        sealBatch();
+    }
+    if (line_.size() > max_batch_bytes_ && !oversize_warned_) {
+        oversize_warned_ = true;
+        LOG_WARN("InfluxLineExporter: Line of " + std::to_string(line_.size()) +
+                 " bytes exceeds max_batch_bytes, sent alone");
+    }
+    if (batch_.empty()) {
+        batch_opened_at_ = std::chrono::steady_clock::now();
+    }
+    batch_ += line_;
+    if (batch_.size() >= max_batch_bytes_) {
+        sealBatch();
+    }
+}
+
+bool InfluxLineExporter::render_line(const TelemetryData& data, std::string& out) {
+    auto prefix = prefixes_.find(data.collector_id);
+    if (prefix == prefixes_.end()) {
+        std::string rendered;
+        appendEscaped(rendered, measurement_, false);
+        rendered += ",collector_id=";
+        appendEscaped(rendered, data.collector_id, true);
+        rendered += ' ';
+        prefix = prefixes_.emplace(data.collector_id, std::move(rendered)).first;
+    }
+
+    size_t start = out.size();
+    out += prefix->second;
+    bool has_field = false;
+    for (const auto& pair : data.values) {
+        if (!std::isfinite(pair.second)) continue; // Non représentable en line protocol
+        if (has_field) out += ',';
+        appendEscaped(out, pair.first, true);
+        out += '=';
+        appendDouble(out, pair.second);
+        has_field = true;
+    }
+    if (!has_field) {
+        out.resize(start);
+        return false;
+    }
+
+    out += ' ';
+    appendInteger(out, std::chrono::duration_cast<std::chrono::nanoseconds>(
+        data.timestamp.time_since_epoch()).count());
+    out += '\n';
+    return true;
+}
+
+void InfluxLineExporter::sealBatch() {
+    // Appelée avec mutex_ verrouillé
+    if (batch_.empty()) return;
+
+    if (ready_.size() >= max_pending_batches_) {
+        // Destination trop lente ou injoignable: le lot le plus ancien est abandonné
+        spare_.push_back(std::move(ready_.front()));
+        ready_.pop_front();
+        dropped_batches_++;
+        if ((dropped_batches_ & (dropped_batches_ - 1)) == 0) {
+            LOG_WARN("InfluxLineExporter: Send queue full, " + std::to_string(dropped_batches_) + " batches dropped");
+        }
+    }
+    ready_.push_back(std::move(batch_));
+
+    if (!spare_.empty()) {
+        batch_ = std::move(spare_.back());
+        spare_.pop_back();
+        batch_.clear();
+    } else {
+        batch_ = std::string();
+        batch_.reserve(max_batch_bytes_);
+    }
+    cv_.notify_one();
+}
+
+bool InfluxLineExporter::openSocket() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = udp_ ? SOCK_DGRAM : SOCK_STREAM;
+    addrinfo* result = nullptr;
+    std::string port = std::to_string(port_);
+    int rc = getaddrinfo(host_.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0) {
+        LOG_ERROR("InfluxLineExporter: Could not resolve " + host_ + ": " + std::string(gai_strerror(rc)));
+        return false;
+    }
+
+    std::string error = "no address";
+    for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+        int sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock < 0) {
+            error = strerror(errno);
+            continue;
+        }
+        // Un envoi bloqué ne doit pas figer le thread d'envoi indéfiniment
+        timeval timeout{2, 0};
+        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        // En UDP, connect() fixe seulement la destination de send()
+        if (::connect(sock, ai->ai_addr, ai->ai_addrlen) < 0) {
+            error = strerror(errno);
+            close(sock);
+            continue;
+        }
+        freeaddrinfo(result);
+        sock_ = sock;
+        LOG_INFO("InfluxLineExporter: Sending line protocol to " + std::string(udp_ ? "udp://" : "tcp://") +
+                 host_ + ":" + port);
+        return true;
+    }
+
+    freeaddrinfo(result);
+    LOG_ERROR("InfluxLineExporter: Connection failed to " + host_ + ":" + port + ": " + error);
+    return false;
+}
+
+void InfluxLineExporter::closeSocket() {
+    if (sock_ != -1) {
+        close(sock_);
+        sock_ = -1;
+    }
+}
+
+bool InfluxLineExporter::sendBatch(const std::string& batch) {
+    if (udp_) {
+        // Un lot = un datagramme; un refus (pas d'écoute) n'invalide pas la socket
+        if (send(sock_, batch.data(), batch.size(), MSG_NOSIGNAL) < 0 && errno != ECONNREFUSED) {
+            LOG_ERROR("InfluxLineExporter: Failed to send datagram: " + std::string(strerror(errno)));
+            return false;
+        }
+        return true;
+    }
+
+    size_t offset = 0;
+    while (offset < batch.size()) {
+        ssize_t written = send(sock_, batch.data() + offset, batch.size() - offset, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("InfluxLineExporter: Failed to send data: " + std::string(strerror(errno)));
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void InfluxLineExporter::senderThreadFunction() {
+    std::deque<std::string> sending;
+
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms_),
+                         [this] { return stop_ || !ready_.empty(); });
+            stopping = stop_;
+
+            // Un lot partiel part au plus tard après flush_interval_ms
+            if (!batch_.empty() && (stopping || std::chrono::steady_clock::now() - batch_opened_at_ >=
+                                                std::chrono::milliseconds(flush_interval_ms_))) {
+                sealBatch();
+            }
+            sending.swap(ready_);
+        }
+
+        // Reconnexion périodique, lots en attente ou non: tant que connected_ est faux,
+        // les collecteurs n'appellent plus export_data() et aucun lot n'arriverait
+        if (sock_ < 0 && !stopping && std::chrono::steady_clock::now() >= next_reconnect_) {
+            connected_ = openSocket();
+            next_reconnect_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(reconnect_interval_ms_);
+        }
+
+        for (auto& batch : sending) {
+            if (sock_ < 0 || !sendBatch(batch)) {
+                if (!udp_) {
+                    closeSocket();
+                    connected_ = false;
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                dropped_batches_++;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (!sending.empty()) {
+                if (spare_.size() < max_pending_batches_) {
+                    spare_.push_back(std::move(sending.front()));
+                }
+                sending.pop_front();
+            }
+        }
+
+        if (stopping) break;
+    }
+}
+
+} // namespace exporters
+} // namespace modbustt
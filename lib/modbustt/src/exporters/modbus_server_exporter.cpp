@@ -0,0 +1,313 @@
+#include "exporters/modbus_server_exporter.h"
+#include "Logger.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+namespace modbustt {
+namespace exporters {
+
+namespace {
+
+// En-tête MBAP: transaction (2), protocole (2), longueur (2) puis unité (1)
+constexpr size_t kMbapLength = 7;
+
+uint16_t clampToRegister(double raw, bool is_signed) {
+    double low = is_signed ? -32768.0 : 0.0;
+    double high = is_signed ? 32767.0 : 65535.0;
+    double clamped = std::min(std::max(std::round(raw), low), high);
+    return static_cast<uint16_t>(static_cast<int32_t>(clamped));
+}
+
+uint32_t clampToDoubleRegister(double raw, bool is_signed) {
+    double low = is_signed ? -2147483648.0 : 0.0;
+    double high = is_signed ? 2147483647.0 : 4294967295.0;
+    double clamped = std::min(std::max(std::round(raw), low), high);
+    return is_signed ? static_cast<uint32_t>(static_cast<int32_t>(clamped)) : static_cast<uint32_t>(clamped);
+}
+
+} // namespace
+
+ModbusServerExporter::~ModbusServerExporter() {
+    disconnect();
+}
+
+void ModbusServerExporter::configure(const nlohmann::json& config) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    listen_address_ = config.value("listen", "0.0.0.0");
+    port_ = config.value("port", 1502);
+    max_clients_ = std::max<size_t>(1, config.value("max_clients", static_cast<size_t>(32)));
+    holding_start_ = config.value("holding_start", 0);
+    holding_count_ = std::max(1, config.value("holding_registers", 1000));
+    input_start_ = config.value("input_start", 0);
+    input_count_ = std::max(1, config.value("input_registers", 1000));
+
+    mappings_.clear();
+    for (const auto& item : config.value("mappings", nlohmann::json::array())) {
+        PointMapping mapping;
+        std::string collector = item.value("collector_id", "");
+        std::string point = item.value("point", "");
+        std::string table = item.value("table", "holding");
+        std::string type = item.value("type", "uint16");
+        mapping.input_table = (table == "input");
+        mapping.scale = item.value("scale", 1.0);
+        mapping.offset = item.value("offset", 0.0);
+        mapping.swap_words = (item.value("word_order", "big") == "little");
+
+        if (type == "int16") mapping.type = ValueType::INT16;
+        else if (type == "uint32") mapping.type = ValueType::UINT32;
+        else if (type == "int32") mapping.type = ValueType::INT32;
+        else if (type == "float32") mapping.type = ValueType::FLOAT32;
+        else mapping.type = ValueType::UINT16;
+
+        int width = (mapping.type == ValueType::UINT16 || mapping.type == ValueType::INT16) ? 1 : 2;
+        int start = mapping.input_table ? input_start_ : holding_start_;
+        int count = mapping.input_table ? input_count_ : holding_count_;
+        int address = item.value("address", -1);
+        if (collector.empty() || point.empty() || mapping.scale == 0.0 ||
+            address < start || address + width > start + count) {
+            LOG_ERROR("ModbusServerExporter: Invalid mapping ignored: " + item.dump());
+            continue;
+        }
+        mapping.address = address - start;
+        mappings_[collector][point].push_back(mapping);
+    }
+
+    master_.holding.assign(static_cast<size_t>(holding_count_), 0);
+    master_.input.assign(static_cast<size_t>(input_count_), 0);
+    for (auto& buffer : buffers_) {
+        buffer = master_;
+    }
+}
+
+bool ModbusServerExporter::connect() {
+    if (running_) return true;
+
+    ctx_ = modbus_new_tcp(listen_address_.c_str(), port_);
+    if (!ctx_) {
+        LOG_ERROR("ModbusServerExporter: Could not create context");
+        return false;
+    }
+    mapping_ = modbus_mapping_new_start_address(0, 0, 0, 0,
+                                                static_cast<unsigned>(holding_start_), static_cast<unsigned>(holding_count_),
+                                                static_cast<unsigned>(input_start_), static_cast<unsigned>(input_count_));
+    if (!mapping_) {
+        LOG_ERROR("ModbusServerExporter: Could not allocate register mapping: " + std::string(modbus_strerror(errno)));
+        modbus_free(ctx_);
+        ctx_ = nullptr;
+        return false;
+    }
+    owned_holding_ = mapping_->tab_registers;
+    owned_input_ = mapping_->tab_input_registers;
+
+    listen_fd_ = modbus_tcp_listen(ctx_, static_cast<int>(max_clients_));
+    if (listen_fd_ < 0) {
+        LOG_ERROR("ModbusServerExporter: Could not listen on " + listen_address_ + ":" + std::to_string(port_) +
+                  ": " + std::string(modbus_strerror(errno)));
+        disconnect();
+        return false;
+    }
+
+    running_ = true;
+    server_thread_ = std::make_unique<std::thread>(&ModbusServerExporter::serverThreadFunction, this);
+    LOG_INFO("ModbusServerExporter: Serving register image on " + listen_address_ + ":" + std::to_string(port_));
+    return true;
+}
+
+void ModbusServerExporter::disconnect() {
+    running_ = false;
+    if (server_thread_) {
+        if (server_thread_->joinable()) {
+            server_thread_->join();
+        }
+        server_thread_.reset();
+    }
+
+    for (const Client& client : clients_) {
+        close(client.fd);
+    }
+    clients_.clear();
+    client_count_ = 0;
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    if (mapping_) {
+        mapping_->tab_registers = owned_holding_;
+        mapping_->tab_input_registers = owned_input_;
+        modbus_mapping_free(mapping_);
+        mapping_ = nullptr;
+    }
+    if (ctx_) {
+        modbus_free(ctx_);
+        ctx_ = nullptr;
+    }
+}
+
+void ModbusServerExporter::export_data(const TelemetryData& data) {
+    auto collector = mappings_.find(data.collector_id);
+    if (collector == mappings_.end()) return;
+
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    bool changed = false;
+    for (const auto& pair : data.values) {
+        auto point = collector->second.find(pair.first);
+        if (point == collector->second.end()) continue;
+        for (const auto& mapping : point->second) {
+            writePoint(mapping, pair.second);
+            changed = true;
+        }
+    }
+    if (!changed) return;
+
+    // Publier une image complète: le tampon rendu par l'échange est celui
+    // que le serveur a fini de lire, ou une image plus ancienne non lue
+    RegisterImage& back = buffers_[write_index_];
+    std::copy(master_.holding.begin(), master_.holding.end(), back.holding.begin());
+    std::copy(master_.input.begin(), master_.input.end(), back.input.begin());
+    write_index_ = latest_.exchange(static_cast<uint8_t>(write_index_ | kFresh), std::memory_order_acq_rel) & 0x3;
+}
+
+void ModbusServerExporter::writePoint(const PointMapping& mapping, double value) {
+    std::vector<uint16_t>& table = mapping.input_table ? master_.input : master_.holding;
+    double raw = (value - mapping.offset) / mapping.scale;
+    if (!std::isfinite(raw)) raw = 0.0;
+
+    uint32_t bits;
+    switch (mapping.type) {
+        case ValueType::UINT16:
+            table[mapping.address] = clampToRegister(raw, false);
+            return;
+        case ValueType::INT16:
+            table[mapping.address] = clampToRegister(raw, true);
+            return;
+        case ValueType::UINT32:
+            bits = clampToDoubleRegister(raw, false);
+            break;
+        case ValueType::INT32:
+            bits = clampToDoubleRegister(raw, true);
+            break;
+        case ValueType::FLOAT32:
+        default: {
+            float f = static_cast<float>(raw);
+            std::memcpy(&bits, &f, sizeof(bits));
+            break;
+        }
+    }
+    uint16_t high = static_cast<uint16_t>(bits >> 16);
+    uint16_t low = static_cast<uint16_t>(bits & 0xFFFF);
+    table[mapping.address] = mapping.swap_words ? low : high;
+    table[mapping.address + 1] = mapping.swap_words ? high : low;
+}
+
+void ModbusServerExporter::serverThreadFunction() {
+    std::vector<pollfd> fds;
+
+    while (running_) {
+        fds.clear();
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const Client& client : clients_) {
+            fds.push_back({client.fd, POLLIN, 0});
+        }
+
+        // Délai court pour réagir à disconnect()
+        int ready = poll(fds.data(), fds.size(), 200);
+        if (ready <= 0) continue;
+
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                handleReadable(fds[i].fd);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int listen_fd = listen_fd_;
+            int client_fd = modbus_tcp_accept(ctx_, &listen_fd);
+            if (client_fd < 0) continue;
+            if (clients_.size() >= max_clients_) {
+                LOG_WARN("ModbusServerExporter: Client refused, max_clients reached");
+                close(client_fd);
+                continue;
+            }
+            fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL, 0) | O_NONBLOCK);
+            Client client;
+            client.fd = client_fd;
+            clients_.push_back(client);
+            client_count_ = clients_.size();
+        }
+    }
+}
+
+void ModbusServerExporter::handleReadable(int client_fd) {
+    auto it = std::find_if(clients_.begin(), clients_.end(),
+                           [client_fd](const Client& client) { return client.fd == client_fd; });
+    if (it == clients_.end()) return;
+    Client& client = *it;
+
+    // Lecture non bloquante de ce qui est arrivé: une requête incomplète attend
+    // la suite dans le tampon du client, sans bloquer le thread serveur
+    ssize_t received = recv(client_fd, client.request + client.length, sizeof(client.request) - client.length, 0);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return;
+    if (received <= 0) {
+        closeClient(client_fd); // Client déconnecté
+        return;
+    }
+    client.length += static_cast<size_t>(received);
+
+    // Requêtes complètes, éventuellement plusieurs à la suite
+    while (client.length >= kMbapLength) {
+        size_t protocol = (static_cast<size_t>(client.request[2]) << 8) | client.request[3];
+        size_t length = 6 + ((static_cast<size_t>(client.request[4]) << 8) | client.request[5]);
+        if (protocol != 0 || length <= kMbapLength || length > MODBUS_TCP_MAX_ADU_LENGTH) {
+            LOG_WARN("ModbusServerExporter: Invalid MBAP header, client disconnected");
+            closeClient(client_fd);
+            return;
+        }
+        if (client.length < length) break;
+
+        if (!replyTo(client_fd, client.request, static_cast<int>(length))) {
+            closeClient(client_fd);
+            return;
+        }
+        std::memmove(client.request, client.request + length, client.length - length);
+        client.length -= length;
+    }
+}
+
+bool ModbusServerExporter::replyTo(int client_fd, const uint8_t* request, int length) {
+    modbus_set_socket(ctx_, client_fd);
+    int function = request[modbus_get_header_length(ctx_)];
+    if (function != MODBUS_FC_READ_HOLDING_REGISTERS && function != MODBUS_FC_READ_INPUT_REGISTERS) {
+        // Image en lecture seule: une écriture serait perdue à la prochaine publication
+        return modbus_reply_exception(ctx_, request, MODBUS_EXCEPTION_ILLEGAL_FUNCTION) >= 0;
+    }
+
+    // Basculer sur l'image la plus récente si une nouvelle a été publiée
+    if (latest_.load(std::memory_order_relaxed) & kFresh) {
+        read_index_ = latest_.exchange(read_index_, std::memory_order_acq_rel) & 0x3;
+    }
+    mapping_->tab_registers = buffers_[read_index_].holding.data();
+    mapping_->tab_input_registers = buffers_[read_index_].input.data();
+
+    if (modbus_reply(ctx_, request, length, mapping_) < 0) {
+        return false; // Réponse impossible à envoyer: client fermé ou qui ne lit plus
+    }
+    requests_served_++;
+    return true;
+}
+
+void ModbusServerExporter::closeClient(int client_fd) {
+    close(client_fd);
+    clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                  [client_fd](const Client& client) { return client.fd == client_fd; }),
+                   clients_.end());
+    client_count_ = clients_.size();
+}
+
+} // namespace exporters
+} // namespace modbustt
@@ -1,10 +1,23 @@
 #include "exporters/mqtt_exporter.h"
 #include "Logger.h"
-#include <iomanip>
+#include <algorithm>
 
 namespace modbustt {
 namespace exporters {
 
+namespace {
+
+/**
+ * @brief Valeur insérée dans un topic: '+', '#' et '/' changeraient sa structure.
+ */
+void appendTopicLevel(std::string& topic, const std::string& value) {
+    for (char c : value) {
+        topic += (c == '+' || c == '#' || c == '/') ? '_' : c;
+    }
+}
+
+} // namespace
+
 MqttExporter::MqttExporter() : qos_(1), connected_(false) {}
 
 MqttExporter::~MqttExporter() {
@@ -19,9 +32,58 @@ void MqttExporter::configure(const nlohmann::json& config) {
     client_id_ = config.value("client_id", "modbustt_exporter");
     topic_ = config.value("topic", "modbustt/data");
     qos_ = config.value("qos", 1);
+    retained_ = config.value("retain", false);
+
+    // Regroupement: linger_ms == 0 publie chaque trame immédiatement
+    linger_ms_ = config.value("linger_ms", 0);
+    max_batch_bytes_ = config.value("max_batch_bytes", static_cast<size_t>(64 * 1024));
+    max_queued_batches_ = std::max<size_t>(1, config.value("max_queued_batches", static_cast<size_t>(16)));
+    max_in_flight_ = std::max<size_t>(1, config.value("max_in_flight", static_cast<size_t>(64)));
+
+    // Encodage des messages et signalement du type de contenu aux abonnés
+    encoding_ = parse_encoding(config.value("encoding", "json"));
+    std::string indicator = config.value("content_type_indicator", "topic_suffix");
+    use_content_type_property_ = (indicator == "property");
+    topic_suffix_.clear();
+    if (indicator == "topic_suffix" && encoding_ != PayloadEncoding::JSON) {
+        topic_suffix_ = "/" + std::string(encoding_name(encoding_));
+    }
+
+    // Routage: "site/{collector_id}" ou "site/{collector_id}/{point}"
+    topic_template_ = config.value("topic_template", "");
+    if (topic_template_.find("{point}") != std::string::npos) {
+        topic_mode_ = TopicMode::PER_POINT;
+    } else if (topic_template_.find("{collector_id}") != std::string::npos) {
+        topic_mode_ = TopicMode::PER_COLLECTOR;
+    } else {
+        topic_mode_ = TopicMode::SINGLE;
+    }
+    publish_topic_ = (topic_template_.empty() ? topic_ : topic_template_) + topic_suffix_;
+    if (topic_mode_ != TopicMode::SINGLE && linger_ms_ > 0) {
+        LOG_WARN("MqttExporter: linger_ms ignored, batching requires a single topic");
+        linger_ms_ = 0;
+    }
+    {
+        std::lock_guard<std::mutex> topic_lock(topic_mutex_);
+        topic_cache_.clear();
+    }
 
     conn_opts_.set_keep_alive_interval(20);
-    conn_opts_.set_clean_session(true);
+    // Les deux indicateurs sont réécrits: une reconfiguration ne garde pas ceux du mode précédent
+    // (clean_session est refusé en v5, clean_start en v3.1.1)
+    publish_properties_ = mqtt::properties();
+    if (use_content_type_property_) {
+        // Les propriétés de message nécessitent MQTT v5, pour le client comme pour la connexion
+        mqtt_version_ = MQTTVERSION_5;
+        conn_opts_.set_clean_session(false);
+        conn_opts_.set_clean_start(true);
+        publish_properties_.add(mqtt::property(mqtt::property::CONTENT_TYPE, std::string(content_type(encoding_))));
+    } else {
+        mqtt_version_ = MQTTVERSION_DEFAULT;
+        conn_opts_.set_clean_start(false);
+        conn_opts_.set_clean_session(true);
+    }
+    conn_opts_.set_mqtt_version(mqtt_version_);
 
     if (config.contains("username") && !config["username"].get<std::string>().empty()) {
         conn_opts_.set_user_name(config["username"].get<std::string>());
@@ -33,7 +95,7 @@ bool MqttExporter::connect() {
     std::lock_guard<std::mutex> lock(connection_mutex_);
     if (connected_) return true;
 
-    client_ = std::make_unique<mqtt::async_client>(server_uri_, client_id_);
+    client_ = std::make_unique<mqtt::async_client>(server_uri_, client_id_, mqtt::create_options(mqtt_version_));
     client_->set_callback(*this);
 
     try {
@@ -50,10 +112,31 @@ bool MqttExporter::connect() {
         connected_ = false;
         return false;
     }
+
+    if (batching_enabled() && !flush_thread_) {
+        {
+            std::lock_guard<std::mutex> batch_lock(batch_mutex_);
+            flush_stop_ = false;
+        }
+        flush_thread_ = std::make_unique<std::thread>(&MqttExporter::flushThreadFunction, this);
+    }
     return connected_;
 }
 
 void MqttExporter::disconnect() {
+    // Publier les lots restants avant de fermer la connexion
+    if (flush_thread_) {
+        {
+            std::lock_guard<std::mutex> batch_lock(batch_mutex_);
+            flush_stop_ = true;
+        }
+        batch_cv_.notify_all();
+        if (flush_thread_->joinable()) {
+            flush_thread_->join();
+        }
+        flush_thread_.reset();
+    }
+
     std::lock_guard<std::mutex> lock(connection_mutex_);
     if (!connected_ || !client_) return;
     try {
@@ -67,21 +150,262 @@ void MqttExporter::disconnect() {
 void MqttExporter::export_data(const TelemetryData& data) {
     if (!connected_) return;
 
+    if (topic_mode_ == TopicMode::PER_POINT) {
+        exportPoints(data, format_timestamp_utc(data.timestamp));
+        return;
+    }
+    const std::string& frame = encoded_frame(data, encoding_);
+
+    if (!batching_enabled()) {
+        Batch batch;
+        batch.payload = frame;
+        batch.frames = 1;
+        if (topic_mode_ == TopicMode::PER_COLLECTOR) {
+            batch.topic = &collectorTopic(data.collector_id);
+        }
+        if (!publishBatch(batch, false)) {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.frames_dropped++;
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    if (pending_.frames == 0) {
+        pending_.payload.reserve(max_batch_bytes_);
+        pending_.opened_at = std::chrono::steady_clock::now();
+    } else {
+        pending_.payload += array_separator(encoding_);
+    }
+    pending_.payload += frame;
+    pending_.frames++;
+
+    // Le lot est scellé dès qu'il atteint la taille maximale, sinon à l'expiration du linger
+    if (pending_.payload.size() >= max_batch_bytes_) {
+        sealPendingBatch();
+        batch_cv_.notify_one();
+    } else if (pending_.frames == 1) {
+        batch_cv_.notify_one(); // Armer l'échéance du linger
+    }
+}
+
+void MqttExporter::exportPoints(const TelemetryData& data, const std::string& timestamp) {
     nlohmann::json j;
-    j["collector_id"] = data.collector_id;
-    auto time_t = std::chrono::system_clock::to_time_t(data.timestamp);
-    std::stringstream ss;
-    ss << std::put_time(std::gmtime(&time_t), "%Y-%m-%dT%H:%M:%SZ");
-    j["timestamp"] = ss.str();
-    j["values"] = data.values;
+    j["timestamp"] = timestamp;
+    bool first = true;
+    size_t dropped = 0;
+    for (const auto& pair : data.values) {
+        j["value"] = pair.second;
+        Batch batch;
+        batch.payload = encode_payload(j, encoding_);
+        // La trame est comptée une fois, sur le message de son premier point
+        batch.frames = first ? 1 : 0;
+        batch.points = 1;
+        batch.topic = &pointTopic(data.collector_id, pair.first);
+        if (!publishBatch(batch, false)) {
+            dropped++;
+        }
+        first = false;
+    }
+    if (dropped > 0) {
+        // Une trame dont un point est perdu est perdue une fois, quel que soit ce point
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.points_dropped += dropped;
+        stats_.frames_dropped++;
+    }
+}
+
+const std::string& MqttExporter::collectorTopic(const std::string& collector_id) {
+    std::lock_guard<std::mutex> lock(topic_mutex_);
+    CollectorTopics& topics = topic_cache_[collector_id];
+    if (topics.frame_topic.empty()) {
+        topics.frame_topic = renderTopic(collector_id, nullptr);
+    }
+    // Les éléments d'un unordered_map ne sont pas déplacés par un rehash
+    return topics.frame_topic;
+}
+
+const std::string& MqttExporter::pointTopic(const std::string& collector_id, const std::string& point) {
+    std::lock_guard<std::mutex> lock(topic_mutex_);
+    auto& point_topics = topic_cache_[collector_id].point_topics;
+    auto it = point_topics.find(point);
+    if (it == point_topics.end()) {
+        it = point_topics.emplace(point, renderTopic(collector_id, &point)).first;
+    }
+    return it->second;
+}
+
+std::string MqttExporter::renderTopic(const std::string& collector_id, const std::string* point) const {
+    static const std::string kCollectorField = "{collector_id}";
+    static const std::string kPointField = "{point}";
+
+    std::string topic;
+    topic.reserve(topic_template_.size() + collector_id.size() + (point ? point->size() : 0) + topic_suffix_.size());
+    size_t position = 0;
+    while (position < topic_template_.size()) {
+        if (topic_template_.compare(position, kCollectorField.size(), kCollectorField) == 0) {
+            appendTopicLevel(topic, collector_id);
+            position += kCollectorField.size();
+        } else if (point && topic_template_.compare(position, kPointField.size(), kPointField) == 0) {
+            appendTopicLevel(topic, *point);
+            position += kPointField.size();
+        } else {
+            topic += topic_template_[position++];
+        }
+    }
+    topic += topic_suffix_;
+    return topic;
+}
+
+MqttExporterStats MqttExporter::get_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    MqttExporterStats stats = stats_;
+    stats.in_flight = in_flight_;
+    return stats;
+}
+
+void MqttExporter::sealPendingBatch() {
+    // Appelée avec batch_mutex_ verrouillé
+    if (pending_.frames == 0) return;
+    pending_.payload.insert(0, array_prefix(encoding_, pending_.frames));
+    pending_.payload += array_suffix(encoding_);
+
+    if (ready_.size() >= max_queued_batches_) {
+        // File de lots pleine: on sacrifie le plus ancien pour borner la mémoire
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.frames_dropped += ready_.front().frames;
+        ready_.pop_front();
+    }
+    ready_.push_back(std::move(pending_));
+    pending_ = Batch();
+}
+
+bool MqttExporter::publishBatch(Batch& batch, bool wait_for_window) {
+    {
+        std::unique_lock<std::mutex> lock(stats_mutex_);
+        // La fenêtre ne borne que les lots, que le thread de publication peut différer.
+        // Sans regroupement, chaque message est confié au client, qui conserve les
+        // publications non acquittées: un message par point ne peut pas attendre son tour.
+        bool windowed = batching_enabled();
+        if (windowed && wait_for_window) {
+            in_flight_cv_.wait_for(lock, std::chrono::milliseconds(100),
+                [this] { return in_flight_ < max_in_flight_ || !connected_; });
+        }
+        if (!connected_ || (windowed && in_flight_ >= max_in_flight_)) {
+            return false;
+        }
+        in_flight_++;
+    }
 
+    auto* context = new InFlight{std::chrono::steady_clock::now(), batch.frames, batch.points};
     try {
-        client_->publish(topic_, j.dump(), qos_, false);
+        const std::string& topic = batch.topic ? *batch.topic : publish_topic_;
+        auto msg = mqtt::make_message(topic, batch.payload.data(), batch.payload.size(), qos_, retained_);
+        if (use_content_type_property_) {
+            msg->set_properties(publish_properties_);
+        }
+        client_->publish(msg, context, *this);
     } catch (const mqtt::exception& e) {
         LOG_ERROR("MqttExporter: Failed to publish message: " + std::string(e.what()));
+        delete context;
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        in_flight_--;
+        stats_.publish_failures++;
+        stats_.frames_dropped += batch.frames;
+        stats_.points_dropped += batch.points;
+        in_flight_cv_.notify_one();
+        return true; // Lot consommé, ne pas le republier
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.batches_published++;
+    stats_.frames_published += batch.frames;
+    stats_.bytes_published += batch.payload.size();
+    stats_.last_batch_frames = batch.frames;
+    stats_.last_batch_bytes = batch.payload.size();
+    stats_.avg_batch_frames = static_cast<double>(stats_.frames_published) / stats_.batches_published;
+    return true;
+}
+
+void MqttExporter::flushThreadFunction() {
+    std::unique_lock<std::mutex> lock(batch_mutex_);
+    while (true) {
+        if (!flush_stop_ && ready_.empty()) {
+            if (pending_.frames > 0) {
+                auto deadline = pending_.opened_at + std::chrono::milliseconds(linger_ms_);
+                batch_cv_.wait_until(lock, deadline, [this] { return flush_stop_ || !ready_.empty(); });
+            } else {
+                batch_cv_.wait(lock, [this] { return flush_stop_ || !ready_.empty() || pending_.frames > 0; });
+                continue; // Recalculer l'échéance du nouveau lot
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (pending_.frames > 0 &&
+            (flush_stop_ || now >= pending_.opened_at + std::chrono::milliseconds(linger_ms_))) {
+            sealPendingBatch();
+        }
+
+        while (!ready_.empty()) {
+            Batch batch = std::move(ready_.front());
+            ready_.pop_front();
+
+            lock.unlock();
+            bool published = publishBatch(batch, true);
+            lock.lock();
+
+            if (!published) {
+                if (connected_ && !flush_stop_) {
+                    // Fenêtre pleine: réessayer au prochain tour
+                    ready_.push_front(std::move(batch));
+                    break;
+                }
+                std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+                stats_.frames_dropped += batch.frames;
+            }
+        }
+
+        if (flush_stop_ && ready_.empty() && pending_.frames == 0) {
+            break;
+        }
     }
 }
 
+void MqttExporter::completeInFlight(const mqtt::token& token, bool success) {
+    auto* context = static_cast<InFlight*>(token.get_user_context());
+    if (!context) return;
+
+    double latency_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - context->sent_at).count();
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        if (in_flight_ > 0) in_flight_--;
+        if (success) {
+            acked_batches_++;
+            total_ack_latency_ms_ += latency_ms;
+            stats_.last_ack_latency_ms = latency_ms;
+            stats_.avg_ack_latency_ms = total_ack_latency_ms_ / acked_batches_;
+            stats_.max_ack_latency_ms = std::max(stats_.max_ack_latency_ms, latency_ms);
+        } else {
+            stats_.publish_failures++;
+            stats_.frames_dropped += context->frames;
+            stats_.points_dropped += context->points;
+        }
+    }
+    in_flight_cv_.notify_one();
+    delete context;
+}
+
+void MqttExporter::on_success(const mqtt::token& token) {
+    completeInFlight(token, true);
+}
+
+void MqttExporter::on_failure(const mqtt::token& token) {
+    LOG_WARN("MqttExporter: Publish failed (return code " + std::to_string(token.get_return_code()) + ")");
+    completeInFlight(token, false);
+}
+
 void MqttExporter::connected(const std::string& cause) {
     LOG_INFO("MqttExporter: Connection successful.");
     connected_ = true;
@@ -90,6 +414,7 @@ void MqttExporter::connected(const std::string& cause) {
 void MqttExporter::connection_lost(const std::string& cause) {
     LOG_WARN("MqttExporter: Connection lost: " + cause);
     connected_ = false;
+    in_flight_cv_.notify_all(); // Ne plus attendre une fenêtre qui ne se libérera pas
     // Note: A robust implementation would attempt to reconnect here.
 }
 
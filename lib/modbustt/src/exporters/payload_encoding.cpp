@@ -0,0 +1,266 @@
+#include "exporters/payload_encoding.h"
+#include "Logger.h"
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+namespace modbustt {
+namespace exporters {
+
+namespace {
+
+void appendJsonString(std::string& out, const std::string& value) {
+    static const char* kHex = "0123456789abcdef";
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += kHex[(c >> 4) & 0xF];
+                    out += kHex[c & 0xF];
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+/**
+ * @brief Nombre au format de json::dump(): chiffres les plus courts, notation
+ * décimale pour les exposants de -5 à 15, ".0" pour les valeurs entières.
+ *
+ * Les chiffres sont ceux de std::to_chars, réellement les plus courts: sur
+ * environ 0,4 % des valeurs, Grisu2 (dump()) en garde un de plus. Les deux
+ * formes relisent la même valeur.
+ */
+void appendJsonNumber(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    // Forme scientifique la plus courte: [-]d[.ddd]e±XX
+    char buffer[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    *std::to_chars(buffer, buffer + sizeof(buffer) - 1, value, std::chars_format::scientific).ptr = '\0';
+#else
+    // Sans to_chars flottant: plus petite précision qui relit la même valeur
+    for (int precision = 0; precision <= 16; ++precision) {
+        std::snprintf(buffer, sizeof(buffer), "%.*e", precision, value);
+        if (std::strtod(buffer, nullptr) == value) break;
+    }
+#endif
+    const char* p = buffer;
+    if (*p == '-') {
+        out += '-';
+        ++p;
+    }
+    char digits[20];
+    int k = 0;
+    for (; *p != 'e'; ++p) {
+        if (*p != '.') digits[k++] = *p;
+    }
+    int exponent = std::atoi(p + 1);
+    int n = exponent + 1;   // Position de la virgule
+
+    if (k <= n && n <= 15) {
+        out.append(digits, static_cast<size_t>(k));
+        out.append(static_cast<size_t>(n - k), '0');
+        out += ".0";
+    } else if (0 < n && n <= 15) {
+        out.append(digits, static_cast<size_t>(n));
+        out += '.';
+        out.append(digits + n, static_cast<size_t>(k - n));
+    } else if (-4 < n && n <= 0) {
+        out += "0.";
+        out.append(static_cast<size_t>(-n), '0');
+        out.append(digits, static_cast<size_t>(k));
+    } else {
+        out += digits[0];
+        if (k > 1) {
+            out += '.';
+            out.append(digits + 1, static_cast<size_t>(k - 1));
+        }
+        int e = n - 1;
+        out += e < 0 ? "e-" : "e+";
+        e = std::abs(e);
+        if (e < 10) out += '0';
+        out += std::to_string(e);
+    }
+}
+
+} // namespace
+
+PayloadEncoding parse_encoding(const std::string& name) {
+    if (name == "json") return PayloadEncoding::JSON;
+    if (name == "cbor") return PayloadEncoding::CBOR;
+    if (name == "msgpack") return PayloadEncoding::MSGPACK;
+    LOG_WARN("Unknown payload encoding '" + name + "', falling back to json");
+    return PayloadEncoding::JSON;
+}
+
+const char* encoding_name(PayloadEncoding encoding) {
+    switch (encoding) {
+        case PayloadEncoding::CBOR: return "cbor";
+        case PayloadEncoding::MSGPACK: return "msgpack";
+        case PayloadEncoding::JSON:
+        default: return "json";
+    }
+}
+
+const char* content_type(PayloadEncoding encoding) {
+    switch (encoding) {
+        case PayloadEncoding::CBOR: return "application/cbor";
+        case PayloadEncoding::MSGPACK: return "application/msgpack";
+        case PayloadEncoding::JSON:
+        default: return "application/json";
+    }
+}
+
+std::string encode_payload(const nlohmann::json& document, PayloadEncoding encoding) {
+    std::string out;
+    encode_payload(document, encoding, out);
+    return out;
+}
+
+void encode_payload(const nlohmann::json& document, PayloadEncoding encoding, std::string& out) {
+    switch (encoding) {
+        case PayloadEncoding::CBOR:
+            nlohmann::json::to_cbor(document, out);
+            break;
+        case PayloadEncoding::MSGPACK:
+            nlohmann::json::to_msgpack(document, out);
+            break;
+        case PayloadEncoding::JSON:
+        default:
+            out += document.dump();
+            break;
+    }
+}
+
+const std::string& encoded_frame(const TelemetryData& data, PayloadEncoding encoding) {
+    size_t index = static_cast<size_t>(encoding);
+    uint8_t bit = static_cast<uint8_t>(1u << index);
+    std::string& out = data.encoded[index];
+    if (!(data.encoded_mask & bit)) {
+        out.clear();
+        write_frame(data, encoding, out);
+        data.encoded_mask |= bit;
+    }
+    return out;
+}
+
+void write_frame(const TelemetryData& data, PayloadEncoding encoding, std::string& out) {
+    if (encoding == PayloadEncoding::JSON) {
+        write_frame_json(data, out);
+        return;
+    }
+    nlohmann::json j;
+    j["collector_id"] = data.collector_id;
+    j["timestamp"] = format_timestamp_utc(data.timestamp);
+    j["values"] = data.values;
+    encode_payload(j, encoding, out);
+}
+
+void write_frame_json(const TelemetryData& data, std::string& out) {
+    // Clés dans l'ordre de nlohmann::json (triées), comme json::dump()
+    out.reserve(out.size() + 64 + data.collector_id.size() + data.values.size() * 32);
+    out += "{\"collector_id\":";
+    appendJsonString(out, data.collector_id);
+    out += ",\"timestamp\":\"";
+    out.append(format_timestamp_utc(data.timestamp), 20);
+    out += "\",\"values\":{";
+    bool first = true;
+    for (const auto& pair : data.values) {
+        if (!first) out += ',';
+        first = false;
+        appendJsonString(out, pair.first);
+        out += ':';
+        appendJsonNumber(out, pair.second);
+    }
+    out += "}}";
+}
+
+const char* format_timestamp_utc(std::chrono::system_clock::time_point timestamp) {
+    thread_local std::time_t cached_second = -1;
+    thread_local char cached_text[32];
+
+    std::time_t second = std::chrono::system_clock::to_time_t(timestamp);
+    if (second != cached_second) {
+        std::tm tm_utc;
+        gmtime_r(&second, &tm_utc);
+        std::strftime(cached_text, sizeof(cached_text), "%Y-%m-%dT%H:%M:%SZ", &tm_utc);
+        cached_second = second;
+    }
+    return cached_text;
+}
+
+std::string array_prefix(PayloadEncoding encoding, size_t count) {
+    std::string out;
+    switch (encoding) {
+        case PayloadEncoding::CBOR:
+            // Type majeur 4 (tableau), longueur sur 0, 1, 2 ou 4 octets
+            if (count < 24) {
+                out += static_cast<char>(0x80 | count);
+            } else if (count <= 0xFF) {
+                out += static_cast<char>(0x98);
+                out += static_cast<char>(count);
+            } else if (count <= 0xFFFF) {
+                out += static_cast<char>(0x99);
+                out += static_cast<char>((count >> 8) & 0xFF);
+                out += static_cast<char>(count & 0xFF);
+            } else {
+                out += static_cast<char>(0x9A);
+                append_length_prefix(out, count);
+            }
+            break;
+        case PayloadEncoding::MSGPACK:
+            if (count < 16) {
+                out += static_cast<char>(0x90 | count);
+            } else if (count <= 0xFFFF) {
+                out += static_cast<char>(0xDC);
+                out += static_cast<char>((count >> 8) & 0xFF);
+                out += static_cast<char>(count & 0xFF);
+            } else {
+                out += static_cast<char>(0xDD);
+                append_length_prefix(out, count);
+            }
+            break;
+        case PayloadEncoding::JSON:
+        default:
+            out = "[";
+            break;
+    }
+    return out;
+}
+
+const char* array_separator(PayloadEncoding encoding) {
+    return encoding == PayloadEncoding::JSON ? "," : "";
+}
+
+const char* array_suffix(PayloadEncoding encoding) {
+    return encoding == PayloadEncoding::JSON ? "]" : "";
+}
+
+void append_length_prefix(std::string& out, size_t length) {
+    uint32_t n = static_cast<uint32_t>(length);
+    out += static_cast<char>((n >> 24) & 0xFF);
+    out += static_cast<char>((n >> 16) & 0xFF);
+    out += static_cast<char>((n >> 8) & 0xFF);
+    out += static_cast<char>(n & 0xFF);
+}
+
+} // namespace exporters
+} // namespace modbustt
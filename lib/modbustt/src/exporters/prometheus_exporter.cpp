@@ -0,0 +1,383 @@
+#include "exporters/prometheus_exporter.h"
+#include "Logger.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <string.h>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace modbustt {
+namespace exporters {
+
+namespace {
+
+// Largeur du champ valeur: la représentation la plus courte d'un double tient en 24 caractères
+constexpr size_t kValueWidth = 24;
+
+const char* kValuesHeader =
+    "# HELP modbus_point_value Latest value of a collected point.\n"
+    "# TYPE modbus_point_value gauge\n";
+
+void appendLabelValue(std::string& out, const std::string& value) {
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+}
+
+/**
+ * @brief Écrit la valeur alignée à droite dans un champ de kValueWidth caractères.
+ *
+ * Les espaces de tête ne font que séparer les étiquettes de la valeur.
+ */
+void writeValueField(char* field, double value) {
+    char buffer[32];
+    size_t length;
+    if (std::isnan(value)) {
+        length = 3;
+        std::memcpy(buffer, "NaN", length);
+    } else if (std::isinf(value)) {
+        length = 4;
+        std::memcpy(buffer, value > 0 ? "+Inf" : "-Inf", length);
+    } else {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        length = static_cast<size_t>(result.ptr - buffer);
+#else
+        length = static_cast<size_t>(std::snprintf(buffer, sizeof(buffer), "%.17g", value));
+#endif
+    }
+    std::memset(field, ' ', kValueWidth - length);
+    std::memcpy(field + kValueWidth - length, buffer, length);
+}
+
+// Début de ligne d'une série, jusqu'au champ valeur exclu
+void appendSeriesPrefix(std::string& out, const std::string& collector_id, const std::string& point) {
+    out += "modbus_point_value{collector_id=\"";
+    appendLabelValue(out, collector_id);
+    out += "\",point=\"";
+    appendLabelValue(out, point);
+    out += "\"} ";
+}
+
+void appendMetric(std::string& out, const char* name, const std::string& collector_id, double value) {
+    out += name;
+    out += "{collector_id=\"";
+    appendLabelValue(out, collector_id);
+    out += "\"} ";
+    char field[kValueWidth];
+    writeValueField(field, value);
+    size_t start = 0;
+    while (start < kValueWidth - 1 && field[start] == ' ') start++;
+    out.append(field + start, kValueWidth - start);
+    out += '\n';
+}
+
+bool sendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+PrometheusExporter::~PrometheusExporter() {
+    disconnect();
+}
+
+void PrometheusExporter::configure(const nlohmann::json& config) {
+    listen_address_ = config.value("listen", "0.0.0.0");
+    port_ = config.value("port", 9464);
+    path_ = config.value("path", "/metrics");
+
+    std::lock_guard<std::mutex> lock(text_mutex_);
+    max_series_ = config.value("max_series", static_cast<size_t>(100000));
+    text_ = kValuesHeader;
+    value_offsets_.clear();
+}
+
+bool PrometheusExporter::connect() {
+    if (running_) return true;
+
+    {
+        std::lock_guard<std::mutex> lock(text_mutex_);
+        if (text_.empty()) text_ = kValuesHeader;
+    }
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        LOG_ERROR("PrometheusExporter: Could not create socket: " + std::string(strerror(errno)));
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port_));
+    if (inet_pton(AF_INET, listen_address_.c_str(), &addr.sin_addr) <= 0 ||
+        bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listen_fd_, 16) < 0) {
+        LOG_ERROR("PrometheusExporter: Could not listen on " + listen_address_ + ":" + std::to_string(port_) +
+                  ": " + std::string(strerror(errno)));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    server_thread_ = std::make_unique<std::thread>(&PrometheusExporter::serverThreadFunction, this);
+    LOG_INFO("PrometheusExporter: Serving http://" + listen_address_ + ":" + std::to_string(port_) + path_);
+    return true;
+}
+
+void PrometheusExporter::disconnect() {
+    running_ = false;
+    if (server_thread_) {
+        if (server_thread_->joinable()) {
+            server_thread_->join();
+        }
+        server_thread_.reset();
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void PrometheusExporter::export_data(const TelemetryData& data) {
+    std::lock_guard<std::mutex> lock(text_mutex_);
+    auto& offsets = value_offsets_[data.collector_id];
+    for (const auto& pair : data.values) {
+        auto it = offsets.find(pair.first);
+        if (it == offsets.end()) {
+            appendSeries(data.collector_id, pair.first);
+            it = offsets.find(pair.first);
+            if (it == offsets.end()) continue;
+        }
+        // Mise à jour sur place du champ valeur
+        writeValueField(&text_[it->second], pair.second);
+    }
+}
+
+void PrometheusExporter::appendSeries(const std::string& collector_id, const std::string& point) {
+    // Appelée avec text_mutex_ verrouillé
+    auto& offsets = value_offsets_[collector_id];
+    size_t series = 0;
+    for (const auto& pair : value_offsets_) series += pair.second.size();
+    if (series >= max_series_) {
+        if (!series_limit_warned_) {
+            series_limit_warned_ = true;
+            LOG_WARN("PrometheusExporter: max_series reached, new points are not exposed");
+        }
+        return;
+    }
+
+    appendSeriesPrefix(text_, collector_id, point);
+    offsets[point] = text_.size();
+    text_.append(kValueWidth, ' ');
+    text_ += '\n';
+}
+
+void PrometheusExporter::removeCollectors(const std::vector<std::string>& collector_ids) {
+    std::lock_guard<std::mutex> lock(text_mutex_);
+    size_t removed = 0;
+    for (const auto& collector_id : collector_ids) {
+        auto it = value_offsets_.find(collector_id);
+        if (it == value_offsets_.end()) continue;
+        removed += it->second.size();
+        value_offsets_.erase(it);
+    }
+    if (removed == 0) return;
+
+    // Reconstruire le bloc: les séries restantes gardent leur dernière valeur
+    std::string text = kValuesHeader;
+    text.reserve(text_.size());
+    for (auto& collector : value_offsets_) {
+        for (auto& point : collector.second) {
+            appendSeriesPrefix(text, collector.first, point.first);
+            size_t offset = text.size();
+            text.append(text_, point.second, kValueWidth);
+            text += '\n';
+            point.second = offset;
+        }
+    }
+    text_.swap(text);
+    series_limit_warned_ = false;
+}
+
+void PrometheusExporter::add_stats_source(const std::string& collector_id, StatsSource source) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_sources_[collector_id] = std::move(source);
+}
+
+std::string PrometheusExporter::render() {
+    // Compteurs d'abord: les collecteurs arrêtés sont retirés avant la copie des valeurs
+    std::string internals;
+    renderInternals(internals);
+
+    std::string out;
+    {
+        std::lock_guard<std::mutex> lock(text_mutex_);
+        out.reserve(text_.size() + internals.size());
+        out.append(text_);
+    }
+    out += internals;
+    return out;
+}
+
+void PrometheusExporter::renderInternals(std::string& out) {
+    std::vector<std::pair<std::string, CollectorStats>> collectors;
+    std::vector<std::string> stopped;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        for (auto it = stats_sources_.begin(); it != stats_sources_.end();) {
+            CollectorStats stats;
+            if (it->second && it->second(stats)) {
+                collectors.emplace_back(it->first, stats);
+                ++it;
+            } else {
+                stopped.push_back(it->first);
+                it = stats_sources_.erase(it);
+            }
+        }
+    }
+    // Collecteur arrêté: ses valeurs disparaissent avec lui
+    if (!stopped.empty()) {
+        removeCollectors(stopped);
+    }
+
+    // Une famille de métriques = un bloc contigu précédé de ses lignes HELP/TYPE
+    struct Family {
+        const char* name;
+        const char* type;
+        const char* help;
+        double (*value)(const CollectorStats&);
+    };
+    static const Family families[] = {
+        {"modbus_collector_scan_duration_seconds", "gauge", "Duration of the last register scan.",
+         [](const CollectorStats& s) { return s.last_scan_duration_s; }},
+        {"modbus_collector_scan_duration_max_seconds", "gauge", "Longest register scan since start.",
+         [](const CollectorStats& s) { return s.max_scan_duration_s; }},
+        {"modbus_collector_export_duration_seconds", "gauge", "Time spent in exporters for the last scan.",
+         [](const CollectorStats& s) { return s.last_export_duration_s; }},
+        {"modbus_collector_export_duration_max_seconds", "gauge", "Longest time spent in exporters since start.",
+         [](const CollectorStats& s) { return s.max_export_duration_s; }},
+        {"modbus_collector_scans_total", "counter", "Register scans performed.",
+         [](const CollectorStats& s) { return static_cast<double>(s.scans); }},
+        {"modbus_collector_scan_errors_total", "counter", "Register scans that failed.",
+         [](const CollectorStats& s) { return static_cast<double>(s.scan_errors); }},
+        {"modbus_collector_connect_failures_total", "counter", "Failed connection attempts.",
+         [](const CollectorStats& s) { return static_cast<double>(s.connect_failures); }},
+        {"modbus_collector_reconnects_total", "counter", "Connections re-established after the first one.",
+         [](const CollectorStats& s) { return static_cast<double>(s.reconnects); }},
+        {"modbus_collector_connected", "gauge", "1 if the collector is connected to its device.",
+         [](const CollectorStats& s) { return s.connected ? 1.0 : 0.0; }},
+    };
+
+    if (!collectors.empty()) {
+        for (const auto& family : families) {
+            out += "# HELP ";
+            out += family.name;
+            out += ' ';
+            out += family.help;
+            out += "\n# TYPE ";
+            out += family.name;
+            out += ' ';
+            out += family.type;
+            out += '\n';
+            for (const auto& collector : collectors) {
+                appendMetric(out, family.name, collector.first, family.value(collector.second));
+            }
+        }
+    }
+
+    out += "# HELP modbus_metrics_scrapes_total Scrapes served by this endpoint.\n"
+           "# TYPE modbus_metrics_scrapes_total counter\n"
+           "modbus_metrics_scrapes_total ";
+    out += std::to_string(scrapes_.load());
+    out += '\n';
+}
+
+void PrometheusExporter::serverThreadFunction() {
+    while (running_) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        // Délai court pour réagir à disconnect()
+        if (poll(&pfd, 1, 200) <= 0) continue;
+
+        int client_fd = accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0) continue;
+        // Un client lent ne bloque pas le serveur plus d'une seconde
+        timeval timeout{1, 0};
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        handleClient(client_fd);
+        close(client_fd);
+    }
+}
+
+void PrometheusExporter::handleClient(int client_fd) {
+    char request[4096];
+    size_t received = 0;
+    while (received < sizeof(request) - 1) {
+        ssize_t n = recv(client_fd, request + received, sizeof(request) - 1 - received, 0);
+        if (n <= 0) return;
+        received += static_cast<size_t>(n);
+        request[received] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) break;
+    }
+    request[received] = '\0';
+
+    // Ligne de requête: "GET <chemin>[?...] HTTP/1.x"
+    std::string line(request, strcspn(request, "\r\n"));
+    std::string target;
+    size_t first_space = line.find(' ');
+    if (first_space != std::string::npos) {
+        size_t second_space = line.find(' ', first_space + 1);
+        target = line.substr(first_space + 1, second_space - first_space - 1);
+        target = target.substr(0, target.find('?'));
+    }
+    std::string method = line.substr(0, first_space);
+
+    if (method != "GET" || target != path_) {
+        const char* not_found = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        sendAll(client_fd, not_found, strlen(not_found));
+        return;
+    }
+
+    scrapes_++;
+    std::string body = render();
+    std::string header = "HTTP/1.1 200 OK\r\n"
+                         "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                         "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                         "Connection: close\r\n\r\n";
+    if (sendAll(client_fd, header.data(), header.size())) {
+        sendAll(client_fd, body.data(), body.size());
+    }
+}
+
+} // namespace exporters
+} // namespace modbustt
@@ -0,0 +1,215 @@
+#include "exporters/shared_memory_exporter.h"
+#include "Logger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <algorithm>
+#include <cstring>
+
+namespace modbustt {
+namespace exporters {
+
+namespace {
+
+uint64_t toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+} // namespace
+
+SharedMemoryExporter::~SharedMemoryExporter() {
+    disconnect();
+}
+
+void SharedMemoryExporter::configure(const nlohmann::json& config) {
+    name_ = config.value("name", "/modbustt");
+    if (name_.empty() || name_[0] != '/') {
+        name_ = "/" + name_;
+    }
+    max_collectors_ = std::max<uint32_t>(1, config.value("max_collectors", 64u));
+    table_capacity_ = std::max<uint32_t>(1, config.value("table_entries", 4096u));
+    ring_capacity_ = std::max<uint32_t>(1, config.value("ring_slots", 1024u));
+    // Borné à 256: taille du tampon de copie de SharedMemoryReader
+    ring_max_points_ = std::min<uint32_t>(256, std::max<uint32_t>(1, config.value("ring_max_points", 64u)));
+}
+
+bool SharedMemoryExporter::connect() {
+    if (header_) return true;
+
+    uint64_t collectors_offset = shm::alignUp(sizeof(shm::Header), shm::kCacheLine);
+    uint64_t table_offset = shm::alignUp(collectors_offset + max_collectors_ * sizeof(shm::CollectorName),
+                                         shm::kCacheLine);
+    uint64_t ring_offset = shm::alignUp(table_offset + table_capacity_ * sizeof(shm::Entry), shm::kCacheLine);
+    uint64_t slot_stride = shm::slotStride(ring_max_points_);
+    uint64_t total_size = ring_offset + ring_capacity_ * slot_stride;
+
+    // Repartir d'une région neuve: les lecteurs attachés à une ancienne instance la gardent
+    shm_unlink(name_.c_str());
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        LOG_ERROR("SharedMemoryExporter: Could not create " + name_ + ": " + std::string(strerror(errno)));
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(total_size)) < 0) {
+        LOG_ERROR("SharedMemoryExporter: Could not size " + name_ + ": " + std::string(strerror(errno)));
+        close(fd);
+        shm_unlink(name_.c_str());
+        return false;
+    }
+    void* base = mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("SharedMemoryExporter: Could not map " + name_ + ": " + std::string(strerror(errno)));
+        shm_unlink(name_.c_str());
+        return false;
+    }
+
+    // ftruncate a mis la région à zéro: compteurs, séquences et noms sont vides
+    base_ = static_cast<uint8_t*>(base);
+    mapped_size_ = total_size;
+    header_ = reinterpret_cast<shm::Header*>(base_);
+    header_->version = shm::kVersion;
+    header_->max_collectors = max_collectors_;
+    header_->table_capacity = table_capacity_;
+    header_->ring_capacity = ring_capacity_;
+    header_->ring_max_points = ring_max_points_;
+    header_->collectors_offset = collectors_offset;
+    header_->table_offset = table_offset;
+    header_->ring_offset = ring_offset;
+    header_->slot_stride = slot_stride;
+    header_->total_size = total_size;
+    header_->state.store(shm::WRITER_LIVE, std::memory_order_relaxed);
+    header_->magic.store(shm::kMagic, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        collectors_.clear();
+        table_full_warned_ = false;
+    }
+
+    LOG_INFO("SharedMemoryExporter: Publishing to " + name_ + " (" + std::to_string(total_size / 1024) + " KB)");
+    return true;
+}
+
+void SharedMemoryExporter::disconnect() {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    if (!header_) return;
+
+    header_->state.store(shm::WRITER_CLOSED, std::memory_order_release);
+    munmap(base_, mapped_size_);
+    shm_unlink(name_.c_str());
+    base_ = nullptr;
+    header_ = nullptr;
+    mapped_size_ = 0;
+}
+
+void SharedMemoryExporter::export_data(const TelemetryData& data) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    if (!header_) return;
+
+    CollectorState* collector = collectorFor(data.collector_id);
+    if (!collector) return;
+
+    int64_t timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        data.timestamp.time_since_epoch()).count();
+
+    uint64_t cursor = header_->ring_head.load(std::memory_order_relaxed) + 1;
+    shm::RingSlotHeader& slot = slotAt(cursor);
+    shm::RingValue* ring_values = reinterpret_cast<shm::RingValue*>(&slot + 1);
+
+    // Seqlock de la case: séquence impaire pendant l'écriture
+    uint64_t slot_sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(slot_sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.cursor.store(cursor, std::memory_order_relaxed);
+    slot.timestamp_ns.store(timestamp_ns, std::memory_order_relaxed);
+    slot.collector.store(collector->index, std::memory_order_relaxed);
+
+    uint32_t count = 0;
+    for (const auto& pair : data.values) {
+        uint32_t index = entryFor(*collector, pair.first);
+        if (index == kInvalidIndex) continue;
+        uint64_t bits = toBits(pair.second);
+
+        shm::Entry& entry = entryAt(index);
+        uint64_t sequence = entry.sequence.load(std::memory_order_relaxed);
+        entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        entry.value_bits.store(bits, std::memory_order_relaxed);
+        entry.timestamp_ns.store(timestamp_ns, std::memory_order_relaxed);
+        entry.sequence.store(sequence + 2, std::memory_order_release);
+
+        if (count < header_->ring_max_points) {
+            ring_values[count].entry.store(index, std::memory_order_relaxed);
+            ring_values[count].value_bits.store(bits, std::memory_order_relaxed);
+            count++;
+        }
+    }
+    slot.count.store(count, std::memory_order_relaxed);
+    slot.sequence.store(slot_sequence + 2, std::memory_order_release);
+    header_->ring_head.store(cursor, std::memory_order_release);
+}
+
+SharedMemoryExporter::CollectorState* SharedMemoryExporter::collectorFor(const std::string& collector_id) {
+    auto it = collectors_.find(collector_id);
+    if (it != collectors_.end()) {
+        return it->second.index == kInvalidIndex ? nullptr : &it->second;
+    }
+
+    uint32_t count = header_->collector_count.load(std::memory_order_relaxed);
+    if (collector_id.size() >= shm::kIdLength || count >= header_->max_collectors) {
+        LOG_WARN("SharedMemoryExporter: Collector " + collector_id +
+                 " not published (id too long or max_collectors reached)");
+        // Mémorisé comme invalide pour ne pas répéter l'avertissement
+        collectors_[collector_id].index = kInvalidIndex;
+        return nullptr;
+    }
+
+    // Nom écrit avant la publication du compteur: immuable pour les lecteurs
+    auto* names = reinterpret_cast<shm::CollectorName*>(base_ + header_->collectors_offset);
+    std::memcpy(names[count].id, collector_id.c_str(), collector_id.size() + 1);
+    header_->collector_count.store(count + 1, std::memory_order_release);
+
+    CollectorState& state = collectors_[collector_id];
+    state.index = count;
+    return &state;
+}
+
+uint32_t SharedMemoryExporter::entryFor(CollectorState& collector, const std::string& point) {
+    auto it = collector.entries.find(point);
+    if (it != collector.entries.end()) return it->second;
+
+    uint32_t count = header_->entry_count.load(std::memory_order_relaxed);
+    if (point.size() >= shm::kNameLength || count >= header_->table_capacity) {
+        if (!table_full_warned_) {
+            table_full_warned_ = true;
+            LOG_WARN("SharedMemoryExporter: Point " + point + " not published (name too long or table full)");
+        }
+        collector.entries[point] = kInvalidIndex;
+        return kInvalidIndex;
+    }
+
+    shm::Entry& entry = entryAt(count);
+    entry.collector = collector.index;
+    std::memcpy(entry.point, point.c_str(), point.size() + 1);
+    header_->entry_count.store(count + 1, std::memory_order_release);
+
+    collector.entries[point] = count;
+    return count;
+}
+
+shm::Entry& SharedMemoryExporter::entryAt(uint32_t index) const {
+    return reinterpret_cast<shm::Entry*>(base_ + header_->table_offset)[index];
+}
+
+shm::RingSlotHeader& SharedMemoryExporter::slotAt(uint64_t cursor) const {
+    uint64_t index = cursor % header_->ring_capacity;
+    return *reinterpret_cast<shm::RingSlotHeader*>(base_ + header_->ring_offset + index * header_->slot_stride);
+}
+
+} // namespace exporters
+} // namespace modbustt
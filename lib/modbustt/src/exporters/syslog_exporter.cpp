@@ -1,49 +1,419 @@
 #include "exporters/syslog_exporter.h"
-#include "Logger.h"
 #include <syslog.h>
-#include <sstream>
+
+namespace {
+// Constantes de syslog.h capturées avant que Logger.h ne redéfinisse LOG_INFO/LOG_DEBUG
+constexpr int kSyslogInfo = LOG_INFO;
+constexpr int kSyslogOptions = LOG_PID | LOG_CONS;
+constexpr int kSyslogUser = LOG_USER;
+}
+#undef LOG_INFO
+#undef LOG_DEBUG
+
+#include "Logger.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <string.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <ctime>
+#include <map>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
 
 namespace modbustt {
 namespace exporters {
 
+namespace {
+
+const std::map<std::string, int> kFacilities = {
+    {"kern", 0}, {"user", 1}, {"daemon", 3}, {"local0", 16}, {"local1", 17}, {"local2", 18},
+    {"local3", 19}, {"local4", 20}, {"local5", 21}, {"local6", 22}, {"local7", 23},
+};
+
+void appendDouble(std::string& out, double value) {
+    char buffer[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, static_cast<size_t>(result.ptr - buffer));
+#else
+    int length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    out.append(buffer, static_cast<size_t>(length));
+#endif
+}
+
+/**
+ * @brief Nom de paramètre RFC 5424: ASCII imprimable sans '=', ' ', ']' ni '"', 32 caractères au plus.
+ */
+void appendParamName(std::string& out, const std::string& name) {
+    size_t length = std::min<size_t>(name.size(), 32);
+    for (size_t i = 0; i < length; ++i) {
+        char c = name[i];
+        bool valid = c > 32 && c < 127 && c != '=' && c != ']' && c != '"';
+        out += valid ? c : '_';
+    }
+}
+
+/**
+ * @brief Valeur de paramètre: '"', '\' et ']' sont échappés.
+ */
+void appendParamValue(std::string& out, const std::string& value) {
+    for (char c : value) {
+        if (c == '"' || c == '\\' || c == ']') out += '\\';
+        out += c;
+    }
+}
+
+/**
+ * @brief Champ d'en-tête: ASCII imprimable sans espace, "-" si vide.
+ */
+std::string headerField(const std::string& value, size_t max_length) {
+    std::string field;
+    for (char c : value.substr(0, max_length)) {
+        field += (c > 32 && c < 127) ? c : '_';
+    }
+    return field.empty() ? "-" : field;
+}
+
+} // namespace
+
+SyslogExporter::~SyslogExporter() {
+    disconnect();
+}
+
 void SyslogExporter::configure(const nlohmann::json& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
     ident_ = config.value("ident", "modbustt");
+
+    std::string format = config.value("format", "text");
+    if (format != "text" && format != "rfc5424") {
+        LOG_WARN("SyslogExporter: Unknown format '" + format + "', using text");
+        format = "text";
+    }
+    structured_ = (format == "rfc5424");
+
+    transport_ = config.value("transport", "unix");
+    if (transport_ != "unix" && transport_ != "udp") {
+        LOG_WARN("SyslogExporter: Unknown transport '" + transport_ + "', using unix");
+        transport_ = "unix";
+    }
+    socket_path_ = config.value("socket_path", "/dev/log");
+    host_ = config.value("host", "127.0.0.1");
+    port_ = config.value("port", 514);
+
+    std::string facility = config.value("facility", "user");
+    auto it = kFacilities.find(facility);
+    if (it == kFacilities.end()) {
+        LOG_WARN("SyslogExporter: Unknown facility '" + facility + "', using user");
+        facility_ = 1;
+    } else {
+        facility_ = it->second;
+    }
+    sd_id_ = config.value("sd_id", "telemetry@32473");
+    max_batch_frames_ = std::max<size_t>(1, config.value("max_batch_frames", static_cast<size_t>(64)));
+    flush_interval_ms_ = std::max(1, config.value("flush_interval_ms", 50));
+    max_pending_frames_ = config.value("max_pending_frames", static_cast<size_t>(10000));
+    reconnect_min_ms_ = std::max(1, config.value("reconnect_min_ms", 100));
+    reconnect_max_ms_ = std::max(reconnect_min_ms_, config.value("reconnect_max_ms", 30000));
 }
 
 bool SyslogExporter::connect() {
     if (connected_) return true;
-    // LOG_PID: include PID with each message
-    // LOG_CONS: write to console if error sending to syslogd
-    // LOG_USER: user-level messages
-    openlog(ident_.c_str(), LOG_PID | LOG_CONS, LOG_USER);
-    // LOG_INFO("SyslogExporter: Connected to syslog daemon with ident '" + ident_ + "'");
+
+    if (!structured_) {
+        // LOG_PID: include PID with each message
+        // LOG_CONS: write to console if error sending to syslogd
+        // LOG_USER: user-level messages
+        openlog(ident_.c_str(), kSyslogOptions, kSyslogUser);
+        connected_ = true;
+        return true;
+    }
+
+    // Première tentative synchrone; en cas d'échec le thread d'envoi réessaie
+    bool ok = openSocket();
+
+    // Parties constantes de l'en-tête, l'horodatage s'insère entre les deux
+    char hostname[256] = {0};
+    gethostname(hostname, sizeof(hostname) - 1);
+    header_ = "<" + std::to_string(facility_ * 8 + kSyslogInfo) + ">1 ";
+    header_tail_ = " " + headerField(hostname, 255) + " " + headerField(ident_, 48) + " " +
+                   std::to_string(getpid()) + " telemetry ";
+
+    stop_ = false;
+    sender_thread_ = std::make_unique<std::thread>(&SyslogExporter::senderThreadFunction, this);
     connected_ = true;
-    return true;
+    if (ok) {
+        LOG_INFO("SyslogExporter: Sending RFC 5424 messages to " +
+                 (transport_ == "unix" ? socket_path_ : host_ + ":" + std::to_string(port_)));
+    }
+    return ok;
 }
 
 void SyslogExporter::disconnect() {
-    if (connected_) {
+    if (!connected_) return;
+
+    if (!structured_) {
         closelog();
         connected_ = false;
+        return;
     }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (sender_thread_ && sender_thread_->joinable()) {
+        sender_thread_->join();
+    }
+    sender_thread_.reset();
+    closeSocket();
+    connected_ = false;
 }
 
 void SyslogExporter::export_data(const TelemetryData& data) {
     if (!connected_) return;
 
-    std::stringstream ss;
-    ss << "collector=" << data.collector_id;
-    for (const auto& pair : data.values) {
-        ss << " " << pair.first << "=" << pair.second;
+    if (!structured_) {
+        std::string message = "collector=" + data.collector_id;
+        char value[32];
+        for (const auto& pair : data.values) {
+            std::snprintf(value, sizeof(value), "%g", pair.second);
+            message += ' ';
+            message += pair.first;
+            message += '=';
+            message += value;
+        }
+        // LOG_INFO is the priority level for the message
+        syslog(kSyslogInfo, "%s", message.c_str());
+        return;
     }
 
-    // LOG_INFO is the priority level for the message
-    syslog(LOG_INFO, "%s", ss.str().c_str());
+    bool batch_full;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_ends_.size() >= max_pending_frames_) {
+            dropped_++;
+            if ((dropped_ & (dropped_ - 1)) == 0) {
+                LOG_WARN("SyslogExporter: Send queue full, " + std::to_string(dropped_) + " frames dropped");
+            }
+            return;
+        }
+        formatMessage(data, pending_);
+        pending_ends_.push_back(pending_.size());
+        batch_full = (pending_ends_.size() == max_batch_frames_);
+    }
+    if (batch_full) {
+        cv_.notify_one();
+    }
 }
 
 bool SyslogExporter::is_connected() const {
     return connected_;
 }
 
+void SyslogExporter::formatMessage(const TelemetryData& data, std::string& out) {
+    // Appelée avec mutex_ verrouillé
+    out += header_;
+    appendTimestamp(data.timestamp, out);
+    out += header_tail_;
+    out += '[';
+    out += sd_id_;
+    out += " collector=\"";
+    appendParamValue(out, data.collector_id);
+    out += '"';
+    for (const auto& pair : data.values) {
+        out += ' ';
+        appendParamName(out, pair.first);
+        out += "=\"";
+        appendDouble(out, pair.second);
+        out += '"';
+    }
+    out += ']';
+}
+
+void SyslogExporter::appendTimestamp(std::chrono::system_clock::time_point timestamp, std::string& out) {
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(timestamp.time_since_epoch()).count();
+    int64_t second = ms / 1000;
+    if (second != cached_second_) {
+        // Date formatée une fois par seconde
+        std::time_t time_t = static_cast<std::time_t>(second);
+        std::tm tm_utc;
+        gmtime_r(&time_t, &tm_utc);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &tm_utc);
+        cached_timestamp_ = buffer;
+        cached_second_ = second;
+    }
+    out += cached_timestamp_;
+    int millis = static_cast<int>(ms % 1000);
+    char fraction[6] = {'.', static_cast<char>('0' + millis / 100), static_cast<char>('0' + millis / 10 % 10),
+                        static_cast<char>('0' + millis % 10), 'Z', '\0'};
+    out += fraction;
+}
+
+bool SyslogExporter::openSocket() {
+    if (transport_ == "unix") {
+        sock_ = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (sock_ < 0) {
+            LOG_ERROR("SyslogExporter: Could not create socket: " + std::string(strerror(errno)));
+            return false;
+        }
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, socket_path_.c_str(), sizeof(addr.sun_path) - 1);
+        if (::connect(sock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            LOG_ERROR("SyslogExporter: Could not connect to " + socket_path_ + ": " + std::string(strerror(errno)));
+            close(sock_);
+            sock_ = -1;
+            return false;
+        }
+        return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    int rc = getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &result);
+    if (rc != 0) {
+        LOG_ERROR("SyslogExporter: Could not resolve " + host_ + ": " + std::string(gai_strerror(rc)));
+        return false;
+    }
+    for (addrinfo* ai = result; ai != nullptr && sock_ < 0; ai = ai->ai_next) {
+        int sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock < 0) continue;
+        if (::connect(sock, ai->ai_addr, ai->ai_addrlen) < 0) {
+            close(sock);
+            continue;
+        }
+        sock_ = sock;
+    }
+    freeaddrinfo(result);
+    if (sock_ < 0) {
+        LOG_ERROR("SyslogExporter: Could not connect to " + host_ + ":" + std::to_string(port_));
+        return false;
+    }
+    return true;
+}
+
+void SyslogExporter::closeSocket() {
+    if (sock_ != -1) {
+        close(sock_);
+        sock_ = -1;
+    }
+}
+
+void SyslogExporter::sendMessages(const std::string& buffer, const std::vector<size_t>& ends) {
+    size_t failed = 0;
+    size_t start = 0;
+    size_t index = 0;
+    int error = 0;
+    while (index < ends.size()) {
+        if (sock_ < 0) {
+            // Socket fermée ou perdue: le reste du lot est abandonné jusqu'à la réouverture
+            failed += ends.size() - index;
+            break;
+        }
+#ifdef __linux__
+        // Un datagramme par message, jusqu'à max_batch_frames_ par appel système
+        size_t count = std::min(max_batch_frames_, ends.size() - index);
+        std::vector<iovec> iov(count);
+        std::vector<mmsghdr> messages(count);
+        size_t offset = start;
+        for (size_t i = 0; i < count; ++i) {
+            iov[i].iov_base = const_cast<char*>(buffer.data() + offset);
+            iov[i].iov_len = ends[index + i] - offset;
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_iov = &iov[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            offset = ends[index + i];
+        }
+        int sent = sendmmsg(sock_, messages.data(), static_cast<unsigned int>(count), MSG_NOSIGNAL);
+        if (sent <= 0) {
+            if (sent < 0 && errno == EINTR) continue;
+            // Message refusé (trop grand, récepteur absent): ignoré, on passe au suivant
+            error = errno;
+            sent = 1;
+            failed++;
+        }
+        index += static_cast<size_t>(sent);
+        start = ends[index - 1];
+#else
+        if (send(sock_, buffer.data() + start, ends[index] - start, MSG_NOSIGNAL) < 0) {
+            error = errno;
+            failed++;
+        }
+        start = ends[index];
+        index++;
+#endif
+        if (error == ECONNREFUSED || error == ENOTCONN || error == ENOENT) {
+            // Démon syslog redémarré: la socket connectée pointe vers l'ancien récepteur
+            LOG_WARN("SyslogExporter: Socket lost (" + std::string(strerror(error)) + "), reopening");
+            closeSocket();
+            error = 0;
+        }
+    }
+
+    if (failed > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t before = dropped_;
+        dropped_ += failed;
+        // Journalisé à chaque franchissement de puissance de deux
+        if ((before ^ dropped_) > before) {
+            LOG_WARN("SyslogExporter: Failed to send messages, " + std::to_string(dropped_) + " frames dropped");
+        }
+    }
+}
+
+void SyslogExporter::senderThreadFunction() {
+    std::string buffer;
+    std::vector<size_t> ends;
+    int backoff_ms = reconnect_min_ms_;
+    auto next_reopen = std::chrono::steady_clock::now();
+    if (sock_ < 0) {
+        // Échec de l'ouverture dans connect(): premier essai après le délai minimal
+        next_reopen += std::chrono::milliseconds(backoff_ms);
+        backoff_ms = std::min(backoff_ms * 2, reconnect_max_ms_);
+    }
+
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms_),
+                         [this] { return stop_ || pending_ends_.size() >= max_batch_frames_; });
+            stopping = stop_;
+            // Échange des tampons: la capacité est conservée des deux côtés
+            buffer.clear();
+            ends.clear();
+            buffer.swap(pending_);
+            ends.swap(pending_ends_);
+        }
+
+        // Réouverture dans ce thread, avec un délai doublé à chaque échec
+        auto now = std::chrono::steady_clock::now();
+        if (sock_ < 0 && !stopping && now >= next_reopen) {
+            if (openSocket()) {
+                LOG_INFO("SyslogExporter: Socket reopened");
+                backoff_ms = reconnect_min_ms_;
+            } else {
+                next_reopen = now + std::chrono::milliseconds(backoff_ms);
+                backoff_ms = std::min(backoff_ms * 2, reconnect_max_ms_);
+            }
+        }
+
+        if (!ends.empty()) {
+            sendMessages(buffer, ends);
+        }
+        if (stopping) break;
+    }
+}
+
 } // namespace exporters
-} // namespace modbustt
\ No newline at end of file
+} // namespace modbustt
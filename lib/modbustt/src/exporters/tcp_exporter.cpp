@@ -1,91 +1,359 @@
 #include "exporters/tcp_exporter.h"
 #include "Logger.h"
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
-#include <sstream>
-#include <fstream>
+#include <algorithm>
+#include <climits>
 
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // SO_NOSIGPIPE est positionné sur la socket (macOS)
+#endif
 
 namespace modbustt {
 namespace exporters {
 
+namespace {
+
+// Nombre maximal de trames par appel à sendmsg
+#ifdef IOV_MAX
+constexpr size_t kMaxIov = IOV_MAX < 1024 ? IOV_MAX : 1024;
+#else
+constexpr size_t kMaxIov = 1024;
+#endif
+
+void setCork(int sock, bool enabled) {
+#ifdef TCP_CORK
+    int value = enabled ? 1 : 0;
+    setsockopt(sock, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+#else
+    (void)sock;
+    (void)enabled;
+#endif
+}
+
+} // namespace
+
 TcpExporter::~TcpExporter() {
     disconnect();
 }
 
 void TcpExporter::configure(const nlohmann::json& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
     host_ = config.value("host", "127.0.0.1");
     port_ = config.value("port", 5170); // Common port for Fluentd TCP input
+    encoding_ = parse_encoding(config.value("encoding", "json"));
+    // Les encodages binaires ne peuvent pas être délimités par '\n'
+    std::string framing = config.value("framing", encoding_ == PayloadEncoding::JSON ? "newline" : "length");
+    length_prefixed_ = (framing == "length" || encoding_ != PayloadEncoding::JSON);
+
+    nodelay_ = config.value("nodelay", true);
+    cork_ = config.value("cork", false);
+    send_buffer_bytes_ = config.value("send_buffer_bytes", 0);
+    connect_timeout_ms_ = std::max(1, config.value("connect_timeout_ms", 2000));
+    reconnect_min_ms_ = std::max(1, config.value("reconnect_min_ms", 100));
+    reconnect_max_ms_ = std::max(reconnect_min_ms_, config.value("reconnect_max_ms", 30000));
+    max_queue_bytes_ = config.value("max_queue_bytes", static_cast<size_t>(16 * 1024 * 1024));
 }
 
 bool TcpExporter::connect() {
-    if (connected_) return true;
+    if (sender_thread_) return connected_;
 
-    sock_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock_ < 0) {
-        LOG_ERROR("TcpExporter: Could not create socket: " + std::string(strerror(errno)));
-        return false;
+    // Première tentative synchrone; en cas d'échec le thread d'envoi réessaie
+    bool ok = openSocket();
+    connected_ = ok;
+
+    stop_ = false;
+    rate_window_start_ = std::chrono::steady_clock::now();
+    sender_thread_ = std::make_unique<std::thread>(&TcpExporter::senderThreadFunction, this);
+    running_ = true;
+    return ok;
+}
+
+void TcpExporter::disconnect() {
+    running_ = false;
+    if (sender_thread_) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (sender_thread_->joinable()) {
+            sender_thread_->join();
+        }
+        sender_thread_.reset();
     }
+    closeSocket();
+    connected_ = false;
 
-    sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!queue_.empty()) {
+        LOG_WARN("TcpExporter: " + std::to_string(queue_.size()) + " frames discarded on disconnect");
+    }
+    queue_.clear();
+    queue_bytes_ = 0;
+    head_offset_ = 0;
+}
 
-    if (inet_pton(AF_INET, host_.c_str(), &server_addr.sin_addr) <= 0) {
-        LOG_ERROR("TcpExporter: Invalid address or address not supported: " + host_);
-        return false;
+void TcpExporter::export_data(const TelemetryData& data) {
+    const std::string& encoded = encoded_frame(data, encoding_);
+    std::string payload;
+    if (length_prefixed_) {
+        payload.reserve(encoded.size() + 4);
+        append_length_prefix(payload, encoded.size());
+        payload += encoded;
+    } else {
+        payload.reserve(encoded.size() + 1);
+        payload += encoded;
+        payload += '\n'; // Add newline for log parsers
     }
 
-    if (::connect(sock_, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        LOG_ERROR("TcpExporter: Connection failed to " + host_ + ":" + std::to_string(port_) + ": " + std::string(strerror(errno)));
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!sender_thread_) return;
+
+        if (queue_bytes_ + payload.size() > max_queue_bytes_) {
+            // File pleine: la trame la plus récente est abandonnée, les trames
+            // en file peuvent être en cours d'envoi
+            stats_.frames_dropped++;
+            if ((stats_.frames_dropped & (stats_.frames_dropped - 1)) == 0) {
+                LOG_WARN("TcpExporter: Send queue full, " + std::to_string(stats_.frames_dropped) + " frames dropped");
+            }
+            return;
+        }
+        was_empty = queue_.empty();
+        queue_bytes_ += payload.size();
+        queue_.push_back(std::move(payload));
+    }
+    // Le thread d'envoi n'attend que lorsque la file est vide
+    if (was_empty) {
+        cv_.notify_one();
+    }
+}
+
+TcpExporterStats TcpExporter::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TcpExporterStats stats = stats_;
+    stats.queued_frames = queue_.size();
+    stats.queued_bytes = queue_bytes_;
+    stats.connected = connected_;
+    return stats;
+}
+
+bool TcpExporter::openSocket() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    std::string port = std::to_string(port_);
+    int rc = getaddrinfo(host_.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0) {
+        LOG_ERROR("TcpExporter: Could not resolve " + host_ + ": " + std::string(gai_strerror(rc)));
         return false;
     }
 
-    LOG_INFO("TcpExporter: Connected to " + host_ + ":" + std::to_string(port_));
-    connected_ = true;
-    return true;
+    std::string error = "no address";
+    for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+        int sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock < 0) {
+            error = strerror(errno);
+            continue;
+        }
+        fcntl(sock, F_SETFD, FD_CLOEXEC);
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+        // Connexion non bloquante bornée par connect_timeout_ms
+        int err = 0;
+        if (::connect(sock, ai->ai_addr, ai->ai_addrlen) < 0) {
+            if (errno != EINPROGRESS) {
+                err = errno;
+            } else {
+                pollfd pfd{sock, POLLOUT, 0};
+                int ready = poll(&pfd, 1, connect_timeout_ms_);
+                if (ready <= 0) {
+                    err = ready == 0 ? ETIMEDOUT : errno;
+                } else {
+                    socklen_t len = sizeof(err);
+                    getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len);
+                }
+            }
+        }
+        if (err != 0) {
+            error = strerror(err);
+            close(sock);
+            continue;
+        }
+
+        int one = 1;
+        if (nodelay_) {
+            setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        if (send_buffer_bytes_ > 0) {
+            setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &send_buffer_bytes_, sizeof(send_buffer_bytes_));
+        }
+#ifdef SO_NOSIGPIPE
+        setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        freeaddrinfo(result);
+        sock_ = sock;
+        LOG_INFO("TcpExporter: Connected to " + host_ + ":" + port);
+        return true;
+    }
+
+    freeaddrinfo(result);
+    LOG_ERROR("TcpExporter: Connection failed to " + host_ + ":" + port + ": " + error);
+    return false;
 }
 
-void TcpExporter::disconnect() {
-    if (connected_ && sock_ != -1) {
+void TcpExporter::closeSocket() {
+    if (sock_ != -1) {
         close(sock_);
         sock_ = -1;
-        connected_ = false;
     }
 }
 
-void TcpExporter::export_data(const TelemetryData& data) {
-    if (!connected_) return;
-
-    nlohmann::json j;
-    j["collector_id"] = data.collector_id;
-    auto time_t = std::chrono::system_clock::to_time_t(data.timestamp);
-    std::stringstream ss;
-    ss << std::put_time(std::gmtime(&time_t), "%Y-%m-%dT%H:%M:%SZ");
-    j["timestamp"] = ss.str();
-    j["values"] = data.values;
-
-    std::string payload = j.dump() + "\n"; // Add newline for log parsers
+bool TcpExporter::sendPending() {
+    // Les trames en file ne sont ni modifiées ni retirées par les producteurs:
+    // les iovec restent valides hors verrou
+    iovec iov[kMaxIov];
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = queue_.begin(); it != queue_.end() && count < kMaxIov; ++it, ++count) {
+            size_t offset = (count == 0) ? head_offset_ : 0;
+            iov[count].iov_base = const_cast<char*>(it->data() + offset);
+            iov[count].iov_len = it->size() - offset;
+        }
+    }
+    if (count == 0) return true;
 
-    if (send(sock_, payload.c_str(), payload.length(), 0) < 0) {
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    ssize_t written = sendmsg(sock_, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (written < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Tampon d'émission plein: attendre qu'il se vide
+            pollfd pfd{sock_, POLLOUT, 0};
+            poll(&pfd, 1, 100);
+            return true;
+        }
+        if (errno == EINTR) return true;
         LOG_ERROR("TcpExporter: Failed to send data: " + std::string(strerror(errno)));
-        disconnect(); // Assume connection is lost
+        return false;
     }
-}
 
-bool TcpExporter::is_connected() const {
-    if (!connected_) return false;
-    // Optional: more robust check
-    char buffer;
-    int err = recv(sock_, &buffer, 1, MSG_PEEK | MSG_DONTWAIT);
-    if (err == 0) { // Peer has closed the connection
-        return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t remaining = static_cast<size_t>(written);
+    while (remaining > 0) {
+        size_t left = queue_.front().size() - head_offset_;
+        if (remaining < left) {
+            // Écriture partielle: la suite de la trame part au prochain envoi
+            head_offset_ += remaining;
+            break;
+        }
+        remaining -= left;
+        queue_bytes_ -= queue_.front().size();
+        queue_.pop_front();
+        head_offset_ = 0;
+        stats_.frames_sent++;
     }
+    stats_.bytes_sent += static_cast<uint64_t>(written);
+    rate_window_bytes_ += static_cast<uint64_t>(written);
     return true;
 }
 
+bool TcpExporter::peerClosed() {
+    char byte;
+    ssize_t rc = recv(sock_, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (rc == 0) return true;
+    return rc < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+}
+
+void TcpExporter::senderThreadFunction() {
+    int backoff_ms = reconnect_min_ms_;
+
+    while (true) {
+        if (sock_ < 0) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (stop_) break;
+            }
+            if (openSocket()) {
+                backoff_ms = reconnect_min_ms_;
+                connected_ = true;
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.reconnects++;
+            } else {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait_for(lock, std::chrono::milliseconds(backoff_ms), [this] { return stop_; });
+                backoff_ms = std::min(backoff_ms * 2, reconnect_max_ms_);
+                continue;
+            }
+        }
+
+        bool stopping;
+        bool has_data;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, std::chrono::milliseconds(200), [this] { return stop_ || !queue_.empty(); });
+            stopping = stop_;
+            has_data = !queue_.empty();
+
+            auto now = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double>(now - rate_window_start_).count();
+            if (elapsed >= 1.0) {
+                stats_.bytes_per_second = rate_window_bytes_ / elapsed;
+                rate_window_bytes_ = 0;
+                rate_window_start_ = now;
+            }
+        }
+
+        bool ok = true;
+        if (has_data) {
+            // Vider la file par lots; à l'arrêt, une dernière vidange bornée
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(connect_timeout_ms_);
+            if (cork_) setCork(sock_, true);
+            while (ok) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (queue_.empty() || (stop_ && !stopping)) break;
+                }
+                if (stopping && std::chrono::steady_clock::now() > deadline) break;
+                ok = sendPending();
+            }
+            if (cork_ && ok) setCork(sock_, false);
+        } else if (!stopping) {
+            // Inactif: détecter la fermeture par le pair sans appel à chaque export
+            ok = !peerClosed();
+            if (!ok) LOG_WARN("TcpExporter: Connection closed by peer");
+        }
+
+        if (stopping) break;
+        if (!ok) {
+            closeSocket();
+            connected_ = false;
+            backoff_ms = reconnect_min_ms_;
+
+            // Une trame partiellement envoyée ne peut pas être reprise sur une nouvelle connexion
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (head_offset_ > 0) {
+                queue_bytes_ -= queue_.front().size();
+                queue_.pop_front();
+                head_offset_ = 0;
+                stats_.frames_dropped++;
+            }
+        }
+    }
+}
+
 } // namespace exporters
-} // namespace modbustt
\ No newline at end of file
+} // namespace modbustt
@@ -0,0 +1,444 @@
+#include "exporters/timeseries_store_exporter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <limits>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace modbustt {
+namespace exporters {
+
+namespace {
+
+constexpr uint32_t kChunkMagic = 0x31435354; // "TSC1"
+
+/**
+ * @brief En-tête d'un bloc scellé, suivi de la clé puis des octets Gorilla.
+ */
+struct ChunkHeader {
+    uint32_t magic;
+    uint32_t count;
+    int64_t t_min;
+    int64_t t_max;
+    uint32_t key_length;
+    uint32_t payload_length;
+};
+
+/**
+ * @brief Projection en lecture seule d'un fichier de partition.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const char*>(data);
+                size_ = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace
+
+TimeSeriesStoreExporter::~TimeSeriesStoreExporter() {
+    disconnect();
+}
+
+void TimeSeriesStoreExporter::configure(const nlohmann::json& config) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    path_ = config.value("path", "tsdb");
+    chunk_points_ = std::max<size_t>(2, config.value("chunk_points", static_cast<size_t>(120)));
+    partition_s_ = std::max<int64_t>(60, config.value("partition_s", static_cast<int64_t>(3600)));
+    retention_hours_ = config.value("retention_hours", 168);
+    max_chunk_age_s_ = std::max(0, config.value("max_chunk_age_s", 60));
+}
+
+bool TimeSeriesStoreExporter::connect() {
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (connected_) return true;
+
+        std::error_code ec;
+        fs::create_directories(path_, ec);
+        if (ec) {
+            LOG_ERROR("TimeSeriesStoreExporter: Could not create " + path_ + ": " + ec.message());
+            return false;
+        }
+        if (!load_index()) {
+            return false;
+        }
+        connected_ = true;
+        LOG_INFO("TimeSeriesStoreExporter: Store opened at " + path_ + " (" + std::to_string(index_.size()) + " series)");
+    }
+    if (max_chunk_age_s_ > 0) {
+        stopping_ = false;
+        sealer_thread_ = std::make_unique<std::thread>(&TimeSeriesStoreExporter::sealerThreadFunction, this);
+    }
+    apply_retention();
+    return true;
+}
+
+void TimeSeriesStoreExporter::disconnect() {
+    if (sealer_thread_) {
+        {
+            std::lock_guard<std::mutex> lock(sealer_mutex_);
+            stopping_ = true;
+        }
+        sealer_cv_.notify_all();
+        if (sealer_thread_->joinable()) {
+            sealer_thread_->join();
+        }
+        sealer_thread_.reset();
+    }
+    flush();
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    connected_ = false;
+}
+
+void TimeSeriesStoreExporter::export_data(const TelemetryData& data) {
+    int64_t timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        data.timestamp.time_since_epoch()).count();
+    int64_t partition = partition_of(timestamp_ms);
+    bool new_partition = false;
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (!connected_) return;
+
+        for (const auto& pair : data.values) {
+            std::string key = series_key(data.collector_id, pair.first);
+            OpenChunk& chunk = open_chunks_[key];
+
+            // Un bloc ne chevauche jamais deux partitions
+            if (chunk.encoder.count() > 0 && chunk.partition != partition) {
+                seal_chunk(key, chunk);
+            }
+            if (chunk.encoder.count() == 0) {
+                chunk.partition = partition;
+                chunk.opened_at = std::chrono::steady_clock::now();
+            }
+            chunk.encoder.append(timestamp_ms, pair.second);
+            if (chunk.encoder.count() >= chunk_points_) {
+                seal_chunk(key, chunk);
+            }
+        }
+        // Les points d'une trame remplissent leurs blocs ensemble: une écriture par partition
+        write_pending();
+
+        if (partition > last_retention_partition_) {
+            last_retention_partition_ = partition;
+            new_partition = true;
+        }
+    }
+
+    if (new_partition) {
+        apply_retention();
+    }
+}
+
+void TimeSeriesStoreExporter::flush() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (auto& pair : open_chunks_) {
+        if (pair.second.encoder.count() > 0) {
+            seal_chunk(pair.first, pair.second);
+        }
+    }
+    write_pending();
+}
+
+void TimeSeriesStoreExporter::apply_retention() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (retention_hours_ <= 0) return;
+
+    int64_t now_s = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t cutoff = now_s - static_cast<int64_t>(retention_hours_) * 3600;
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(path_, ec)) {
+        if (entry.path().extension() != ".tsdb") continue;
+        int64_t partition = std::strtoll(entry.path().stem().c_str(), nullptr, 10);
+        if (partition + partition_s_ <= cutoff) {
+            fs::remove(entry.path(), ec);
+            LOG_INFO("TimeSeriesStoreExporter: Partition expired: " + entry.path().string());
+        }
+    }
+
+    // Purger l'index des blocs des partitions supprimées
+    for (auto it = index_.begin(); it != index_.end();) {
+        auto& chunks = it->second;
+        chunks.erase(std::remove_if(chunks.begin(), chunks.end(),
+            [&](const ChunkLocation& c) { return c.partition + partition_s_ <= cutoff; }), chunks.end());
+        if (chunks.empty() && open_chunks_.find(it->first) == open_chunks_.end()) {
+            it = index_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<std::string> TimeSeriesStoreExporter::list_series() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<std::string> series;
+    for (const auto& pair : index_) series.push_back(pair.first);
+    for (const auto& pair : open_chunks_) {
+        if (index_.find(pair.first) == index_.end()) series.push_back(pair.first);
+    }
+    std::sort(series.begin(), series.end());
+    return series;
+}
+
+std::vector<TimeSeriesPoint> TimeSeriesStoreExporter::query(const std::string& collector_id, const std::string& point,
+                                                            int64_t from_ms, int64_t to_ms) const {
+    std::vector<TimeSeriesPoint> points;
+    read_chunks(series_key(collector_id, point), from_ms, to_ms, points);
+    std::stable_sort(points.begin(), points.end(),
+        [](const TimeSeriesPoint& a, const TimeSeriesPoint& b) { return a.timestamp_ms < b.timestamp_ms; });
+    return points;
+}
+
+std::vector<TimeSeriesBucket> TimeSeriesStoreExporter::query_downsampled(const std::string& collector_id,
+                                                                         const std::string& point,
+                                                                         int64_t from_ms, int64_t to_ms,
+                                                                         int64_t bucket_ms) const {
+    std::vector<TimeSeriesBucket> buckets;
+    if (bucket_ms <= 0) return buckets;
+
+    for (const auto& p : query(collector_id, point, from_ms, to_ms)) {
+        int64_t start = from_ms + ((p.timestamp_ms - from_ms) / bucket_ms) * bucket_ms;
+        if (buckets.empty() || buckets.back().start_ms != start) {
+            buckets.push_back({start, p.value, p.value, 0.0, p.value, 0});
+        }
+        TimeSeriesBucket& b = buckets.back();
+        b.min = std::min(b.min, p.value);
+        b.max = std::max(b.max, p.value);
+        b.avg += (p.value - b.avg) / static_cast<double>(b.count + 1);
+        b.last = p.value;
+        b.count++;
+    }
+    return buckets;
+}
+
+std::string TimeSeriesStoreExporter::series_key(const std::string& collector_id, const std::string& point) {
+    return collector_id + "/" + point;
+}
+
+int64_t TimeSeriesStoreExporter::partition_of(int64_t timestamp_ms) const {
+    int64_t seconds = timestamp_ms / 1000;
+    return seconds - (seconds % partition_s_);
+}
+
+std::string TimeSeriesStoreExporter::partition_path(int64_t partition) const {
+    return path_ + "/" + std::to_string(partition) + ".tsdb";
+}
+
+void TimeSeriesStoreExporter::seal_chunk(const std::string& key, OpenChunk& chunk) {
+    // Appelée avec mutex_ verrouillé en écriture; write_pending() écrit le bloc
+    const std::string& payload = chunk.encoder.bytes();
+    ChunkHeader header;
+    header.magic = kChunkMagic;
+    header.count = static_cast<uint32_t>(chunk.encoder.count());
+    header.t_min = chunk.encoder.first_timestamp();
+    header.t_max = chunk.encoder.last_timestamp();
+    header.key_length = static_cast<uint32_t>(key.size());
+    header.payload_length = static_cast<uint32_t>(payload.size());
+
+    PendingWrite& pending = pending_[chunk.partition];
+    pending.chunks.push_back({key, {chunk.partition, pending.records.size(), header.t_min, header.t_max}});
+    pending.records.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    pending.records += key;
+    pending.records += payload;
+    chunk = OpenChunk();
+}
+
+void TimeSeriesStoreExporter::write_pending() {
+    // Appelée avec mutex_ verrouillé en écriture
+    for (auto& pair : pending_) {
+        PendingWrite& pending = pair.second;
+        std::string path = partition_path(pair.first);
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            LOG_ERROR("TimeSeriesStoreExporter: Could not open " + path + ": " + std::string(strerror(errno)));
+            continue;
+        }
+
+        struct stat st;
+        uint64_t offset = (fstat(fd, &st) == 0) ? static_cast<uint64_t>(st.st_size) : 0;
+        ssize_t written = ::write(fd, pending.records.data(), pending.records.size());
+        if (written != static_cast<ssize_t>(pending.records.size())) {
+            // Retirer les enregistrements partiels: les blocs suivants seraient écrits après eux
+            LOG_ERROR("TimeSeriesStoreExporter: Short write on " + path + ", " +
+                      std::to_string(pending.chunks.size()) + " chunks lost");
+            if (written > 0 && ::ftruncate(fd, static_cast<off_t>(offset)) != 0) {
+                LOG_ERROR("TimeSeriesStoreExporter: Could not truncate " + path + ": " + std::string(strerror(errno)));
+            }
+        } else {
+            for (auto& chunk : pending.chunks) {
+                chunk.second.offset += offset;
+                index_[chunk.first].push_back(chunk.second);
+            }
+        }
+        ::close(fd);
+    }
+    pending_.clear();
+}
+
+void TimeSeriesStoreExporter::sealerThreadFunction() {
+    const auto max_age = std::chrono::seconds(max_chunk_age_s_);
+    std::unique_lock<std::mutex> wait_lock(sealer_mutex_);
+    while (!stopping_) {
+        // Un bloc est scellé au plus une seconde après avoir atteint max_chunk_age_s
+        sealer_cv_.wait_for(wait_lock, std::chrono::seconds(1), [this] { return stopping_; });
+        if (stopping_) break;
+        wait_lock.unlock();
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto now = std::chrono::steady_clock::now();
+            for (auto& pair : open_chunks_) {
+                if (pair.second.encoder.count() > 0 && now - pair.second.opened_at >= max_age) {
+                    seal_chunk(pair.first, pair.second);
+                }
+            }
+            write_pending();
+        }
+        wait_lock.lock();
+    }
+}
+
+bool TimeSeriesStoreExporter::load_index() {
+    // Appelée avec mutex_ verrouillé en écriture
+    index_.clear();
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(path_, ec)) {
+        if (entry.path().extension() != ".tsdb") continue;
+        int64_t partition = std::strtoll(entry.path().stem().c_str(), nullptr, 10);
+        scan_partition(partition, entry.path().string());
+        last_retention_partition_ = std::max(last_retention_partition_, partition);
+    }
+    if (ec) {
+        LOG_ERROR("TimeSeriesStoreExporter: Could not list " + path_ + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
+
+void TimeSeriesStoreExporter::scan_partition(int64_t partition, const std::string& path) {
+    size_t offset = 0;
+    size_t file_size = 0;
+    {
+        MappedFile file(path);
+        file_size = file.size();
+        while (offset + sizeof(ChunkHeader) <= file.size()) {
+            ChunkHeader header;
+            std::memcpy(&header, file.data() + offset, sizeof(header));
+            size_t record_size = sizeof(header) + header.key_length + header.payload_length;
+            if (header.magic != kChunkMagic || offset + record_size > file.size()) {
+                break;
+            }
+            std::string key(file.data() + offset + sizeof(header), header.key_length);
+            index_[key].push_back({partition, offset, header.t_min, header.t_max});
+            offset += record_size;
+        }
+    }
+
+    // Fin tronquée (arrêt brutal pendant une écriture): les blocs scellés ensuite
+    // seraient ajoutés derrière elle et ignorés au prochain démarrage
+    if (offset < file_size) {
+        LOG_WARN("TimeSeriesStoreExporter: Truncated chunk removed from " + path + " (" +
+                 std::to_string(file_size - offset) + " bytes)");
+        if (::truncate(path.c_str(), static_cast<off_t>(offset)) != 0) {
+            LOG_ERROR("TimeSeriesStoreExporter: Could not truncate " + path + ": " + std::string(strerror(errno)));
+        }
+    }
+}
+
+void TimeSeriesStoreExporter::read_chunks(const std::string& key, int64_t from_ms, int64_t to_ms,
+                                          std::vector<TimeSeriesPoint>& out) const {
+    std::vector<ChunkLocation> locations;
+    std::string open_bytes;
+    size_t open_count = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            for (const auto& c : it->second) {
+                if (c.t_max >= from_ms && c.t_min <= to_ms) locations.push_back(c);
+            }
+        }
+        // Bloc encore en mémoire
+        auto open = open_chunks_.find(key);
+        if (open != open_chunks_.end() && open->second.encoder.count() > 0 &&
+            open->second.encoder.last_timestamp() >= from_ms && open->second.encoder.first_timestamp() <= to_ms) {
+            open_bytes = open->second.encoder.bytes();
+            open_count = open->second.encoder.count();
+        }
+    }
+
+    auto decode = [&](const char* data, size_t size, size_t count) {
+        GorillaDecoder decoder(data, size, count);
+        int64_t timestamp_ms;
+        double value;
+        while (decoder.next(timestamp_ms, value)) {
+            if (timestamp_ms >= from_ms && timestamp_ms <= to_ms) {
+                out.push_back({timestamp_ms, value});
+            }
+        }
+    };
+
+    // Les blocs sont regroupés par partition pour ne projeter chaque fichier qu'une fois
+    std::sort(locations.begin(), locations.end(),
+        [](const ChunkLocation& a, const ChunkLocation& b) {
+            return a.partition < b.partition || (a.partition == b.partition && a.offset < b.offset);
+        });
+
+    std::unique_ptr<MappedFile> file;
+    int64_t mapped_partition = std::numeric_limits<int64_t>::min();
+    for (const auto& c : locations) {
+        if (c.partition != mapped_partition) {
+            file = std::make_unique<MappedFile>(partition_path(c.partition));
+            mapped_partition = c.partition;
+        }
+        if (c.offset + sizeof(ChunkHeader) > file->size()) continue; // Partition supprimée entre-temps
+
+        ChunkHeader header;
+        std::memcpy(&header, file->data() + c.offset, sizeof(header));
+        size_t payload_offset = c.offset + sizeof(header) + header.key_length;
+        if (header.magic != kChunkMagic || payload_offset + header.payload_length > file->size()) continue;
+        decode(file->data() + payload_offset, header.payload_length, header.count);
+    }
+
+    if (open_count > 0) {
+        decode(open_bytes.data(), open_bytes.size(), open_count);
+    }
+}
+
+} // namespace exporters
+} // namespace modbustt
@@ -0,0 +1,180 @@
+#include "exporters/zmq_exporter.h"
+#include "Logger.h"
+#include <zmq.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace modbustt {
+namespace exporters {
+
+ZmqExporter::BufferPool::~BufferPool() {
+    for (PooledBuffer* buffer : idle_) {
+        delete buffer;
+    }
+}
+
+ZmqExporter::PooledBuffer* ZmqExporter::BufferPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty()) {
+            PooledBuffer* buffer = idle_.back();
+            idle_.pop_back();
+            buffer->data.clear();
+            return buffer;
+        }
+    }
+    return new PooledBuffer{this, std::string()};
+}
+
+void ZmqExporter::BufferPool::release(PooledBuffer* buffer) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < max_idle_) {
+            idle_.push_back(buffer);
+            return;
+        }
+    }
+    delete buffer;
+}
+
+void ZmqExporter::releaseBuffer(void* /*data*/, void* hint) {
+    // Appelée par ZeroMQ lorsque le message a été transmis (ou abandonné)
+    PooledBuffer* buffer = static_cast<PooledBuffer*>(hint);
+    buffer->pool->release(buffer);
+}
+
+ZmqExporter::~ZmqExporter() {
+    disconnect();
+}
+
+void ZmqExporter::configure(const nlohmann::json& config) {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    endpoint_ = config.value("endpoint", "tcp://*:5556");
+    bind_ = config.value("bind", true);
+    topic_prefix_ = config.value("topic_prefix", "");
+    encoding_ = parse_encoding(config.value("encoding", "json"));
+    send_hwm_ = config.value("send_hwm", 10000);
+    linger_ms_ = config.value("linger_ms", 0);
+    io_threads_ = std::max(1, config.value("io_threads", 1));
+    pool_size_ = config.value("pool_size", static_cast<size_t>(256));
+}
+
+bool ZmqExporter::connect() {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    if (connected_) return true;
+
+    if (!pool_) {
+        pool_ = std::make_unique<BufferPool>(pool_size_);
+    }
+    context_ = zmq_ctx_new();
+    if (!context_) {
+        handleError("Could not create context");
+        return false;
+    }
+    zmq_ctx_set(context_, ZMQ_IO_THREADS, io_threads_);
+
+    socket_ = zmq_socket(context_, ZMQ_PUB);
+    if (!socket_) {
+        handleError("Could not create PUB socket");
+        zmq_ctx_term(context_);
+        context_ = nullptr;
+        return false;
+    }
+    zmq_setsockopt(socket_, ZMQ_SNDHWM, &send_hwm_, sizeof(send_hwm_));
+    zmq_setsockopt(socket_, ZMQ_LINGER, &linger_ms_, sizeof(linger_ms_));
+
+    int rc = bind_ ? zmq_bind(socket_, endpoint_.c_str()) : zmq_connect(socket_, endpoint_.c_str());
+    if (rc != 0) {
+        handleError(std::string(bind_ ? "Bind" : "Connect") + " failed on " + endpoint_);
+        zmq_close(socket_);
+        zmq_ctx_term(context_);
+        socket_ = nullptr;
+        context_ = nullptr;
+        return false;
+    }
+
+    LOG_INFO("ZmqExporter: Publishing on " + endpoint_);
+    connected_ = true;
+    return true;
+}
+
+void ZmqExporter::disconnect() {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    if (socket_) {
+        zmq_close(socket_);
+        socket_ = nullptr;
+    }
+    if (context_) {
+        // Attend linger_ms au plus; tous les tampons prêtés sont rendus au retour
+        zmq_ctx_term(context_);
+        context_ = nullptr;
+    }
+    connected_ = false;
+}
+
+void ZmqExporter::export_data(const TelemetryData& data) {
+    if (!connected_) return;
+
+    // Trame encodée directement dans le tampon prêté à ZeroMQ
+    PooledBuffer* buffer = pool_->acquire();
+    write_frame(data, encoding_, buffer->data);
+
+    zmq_msg_t payload;
+    if (zmq_msg_init_data(&payload, &buffer->data[0], buffer->data.size(), &ZmqExporter::releaseBuffer, buffer) != 0) {
+        pool_->release(buffer);
+        handleError("Could not initialise message");
+        return;
+    }
+
+    // Première partie: le topic, sur lequel les abonnés filtrent. Écrit dans le
+    // message lui-même: un topic court est stocké sans allocation par ZeroMQ
+    zmq_msg_t topic;
+    if (zmq_msg_init_size(&topic, topic_prefix_.size() + data.collector_id.size()) != 0) {
+        zmq_msg_close(&payload);
+        handleError("Could not initialise topic");
+        return;
+    }
+    char* topic_data = static_cast<char*>(zmq_msg_data(&topic));
+    std::memcpy(topic_data, topic_prefix_.data(), topic_prefix_.size());
+    std::memcpy(topic_data + topic_prefix_.size(), data.collector_id.data(), data.collector_id.size());
+
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    if (!socket_) {
+        zmq_msg_close(&topic);
+        zmq_msg_close(&payload);
+        return;
+    }
+
+    if (zmq_msg_send(&topic, socket_, ZMQ_SNDMORE | ZMQ_DONTWAIT) < 0) {
+        // Rien n'est parti: les deux parties restent à nous, fermer le payload rend le tampon au pool
+        zmq_msg_close(&topic);
+        zmq_msg_close(&payload);
+        uint64_t dropped = ++dropped_;
+        if ((dropped & (dropped - 1)) == 0) {
+            handleError(std::to_string(dropped) + " messages dropped");
+        }
+        return;
+    }
+
+    // Le topic est accepté: le payload doit suivre, sinon le message suivant serait
+    // ajouté à ce message multipart. Un socket PUB ne bloque pas (au-delà du HWM le
+    // message entier est abandonné), seul EINTR peut être réessayé
+    while (zmq_msg_send(&payload, socket_, 0) < 0) {
+        if (zmq_errno() == EINTR) continue;
+        zmq_msg_close(&payload);
+        // Message multipart incomplet (contexte arrêté, socket invalide): la socket est fermée
+        handleError("Could not send payload part, closing socket");
+        zmq_close(socket_);
+        socket_ = nullptr;
+        connected_ = false;
+        return;
+    }
+}
+
+void ZmqExporter::handleError(const std::string& errorMessage) {
+    LOG_ERROR("ZmqExporter: " + errorMessage + ": " + std::string(zmq_strerror(zmq_errno())));
+}
+
+} // namespace exporters
+} // namespace modbustt
@@ -1,11 +1,21 @@
 #include "modbus_collector.h"
 #include "Logger.h" // On suppose que le logger est accessible
+#include "ThreadTuning.h"
 #include <chrono>
 
 namespace modbustt {
 
 ModbusCollector::ModbusCollector(const CollectorConfig& config)
-    : config_(config), acquisitionPeriod_(config.acquisition_frequency_ms) {}
+    : config_(config), acquisitionPeriod_(config.acquisition_frequency_ms) {
+    if (config_.register_table) {
+        registers_ = config_.register_table;
+    } else {
+        registers_ = std::make_shared<const RegisterTable>(std::move(config_.registers));
+    }
+    // Une seule copie des registres: la table
+    config_.registers.clear();
+    config_.register_table.reset();
+}
 
 ModbusCollector::~ModbusCollector() {
     stop();
@@ -62,7 +72,27 @@ void ModbusCollector::setFrequency(int frequencyMs) {
     controlCondition_.notify_one();
 }
 
+void ModbusCollector::setRegisters(const std::vector<RegisterConfig>& registers) {
+    setRegisters(std::make_shared<const RegisterTable>(registers));
+}
+
+void ModbusCollector::setRegisters(std::shared_ptr<const RegisterTable> registers) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    pendingRegisters_ = std::move(registers);
+    controlQueue_.push({CollectorCommand::SET_REGISTERS});
+    controlCondition_.notify_one();
+}
+
 void ModbusCollector::threadFunction() {
+    ThreadTuning tuning;
+    tuning.name = "acq-" + config_.id;
+    tuning.cpuAffinity = config_.cpu_affinity;
+    tuning.schedPolicy = config_.sched_policy;
+    tuning.schedPriority = config_.sched_priority;
+    tuning.prefaultStack = config_.prefault_stack;
+    applyThreadTuning(tuning);
+    Logger::setThreadContext(config_.id);
+
     LOG_INFO("Collector thread running for: " + config_.id);
     while (!stopRequested_) {
         processControlMessages();
@@ -82,7 +112,27 @@ void ModbusCollector::threadFunction() {
         }
 
         if (connected_) {
-            readRegisters();
+            // Durées mesurées séparément: un exporter lent ne passe pas pour un automate lent
+            std::map<std::string, double> values;
+            auto scanStart = std::chrono::steady_clock::now();
+            bool scanOk = readRegisters(values);
+            auto scanEnd = std::chrono::steady_clock::now();
+            uint64_t durationUs = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(scanEnd - scanStart).count());
+            scans_++;
+            if (!scanOk) scanErrors_++;
+            lastScanDurationUs_ = durationUs;
+            if (durationUs > maxScanDurationUs_) maxScanDurationUs_ = durationUs;
+
+            if (scanOk && !values.empty()) {
+                // TODO: Ajouter alternative pour ne pas bloquer le thread ET ne pas perdre de données si aucune exporter est configurée ou est déconnectée
+                // La réexposition Modbus des données (mbserve) est assurée par modbustt::exporters::ModbusServerExporter
+                exportData(TelemetryData(config_.id, values));
+                uint64_t exportUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - scanEnd).count());
+                lastExportDurationUs_ = exportUs;
+                if (exportUs > maxExportDurationUs_) maxExportDurationUs_ = exportUs;
+            }
         }
 
         // Attente contrôlée par la condition variable pour un arrêt réactif
@@ -119,10 +169,13 @@ bool ModbusCollector::connectToModbus() {
         LOG_ERROR("Modbus connection failed for " + config_.id + ": " + modbus_strerror(errno));
         modbus_free(modbusContext_);
         modbusContext_ = nullptr;
+        connectFailures_++;
         return false;
     }
 
     connected_ = true;
+    statsConnected_ = true;
+    connections_++;
     LOG_INFO("Modbus connection established for " + config_.id);
     return true;
 }
@@ -134,15 +187,30 @@ void ModbusCollector::disconnectFromModbus() {
         modbusContext_ = nullptr;
     }
     connected_ = false;
+    statsConnected_ = false;
+}
+
+CollectorStats ModbusCollector::getStats() const {
+    CollectorStats stats;
+    stats.scans = scans_;
+    stats.scan_errors = scanErrors_;
+    stats.connect_failures = connectFailures_;
+    uint64_t connections = connections_;
+    stats.reconnects = connections > 0 ? connections - 1 : 0;
+    stats.last_scan_duration_s = lastScanDurationUs_ / 1e6;
+    stats.max_scan_duration_s = maxScanDurationUs_ / 1e6;
+    stats.last_export_duration_s = lastExportDurationUs_ / 1e6;
+    stats.max_export_duration_s = maxExportDurationUs_ / 1e6;
+    stats.connected = statsConnected_;
+    return stats;
 }
 
-bool ModbusCollector::readRegisters() {
+bool ModbusCollector::readRegisters(std::map<std::string, double>& values) {
     if (!connected_ || !modbusContext_) return false;
 
-    std::map<std::string, double> values;
     bool success = true;
 
-    for (const auto& reg : config_.registers) {
+    for (const auto& reg : *registers_) {
         uint16_t rawValue[1] = {0};
         int result = -1;
 
@@ -164,6 +232,7 @@ bool ModbusCollector::readRegisters() {
             LOG_ERROR("Error reading register " + std::to_string(reg.address) + " for " + config_.id + ": " + modbus_strerror(errno));
             success = false;
             connected_ = false; // Assume connection is lost on error
+            statsConnected_ = false;
             break;
         } else {
             double scaledValue = (static_cast<double>(rawValue[0]) * reg.scale) + reg.offset;
@@ -171,17 +240,6 @@ bool ModbusCollector::readRegisters() {
         }
     }
 
-    if (success && !values.empty()) {
-        // Créer un objet TelemetryData et l'exporter
-        TelemetryData data(config_.id, values);
-        // TODO: Ajouter alternative pour ne pas bloquer le thread ET ne pas perdre de données si aucune exporter est configurée ou est déconnectée
-        // La lib sert à ingérer des données, pas à les stocker dans le cadre du développement du mbserve, 
-        // il faudra un exporter en mémoire (un exporter qui stocke les données dans une structure modbus server, 
-        // modbustt::exporters::InMemoryExporter, peut être cette implémentation là)
-        // C'est à mbserve de gérer les problèmatiques de persistences de data, configuration InMemoryExporter pour representer un buffer de données Modbus
-        exportData(data);
-    }
-
     return success;
 }
 
@@ -219,7 +277,12 @@ void ModbusCollector::processControlMessages() {
                 break;
             case CollectorCommand::SET_FREQUENCY:
                 acquisitionPeriod_ = std::chrono::milliseconds(msg.parameter);
-                LOG_INFO("Frequency updated for " + config_.id + ": " + std::to_string(msg.parameter) + "ms");
+                LOG_INFO("Frequency updated for {}: {}ms", config_.id, msg.parameter);
+                break;
+            case CollectorCommand::SET_REGISTERS:
+                // Appliqué par le thread de collecte: readRegisters() ne voit jamais une liste partielle
+                if (pendingRegisters_) registers_ = std::move(pendingRegisters_);
+                LOG_INFO("Registers updated for {}: {} registers", config_.id, registers_->size());
                 break;
         }
     }
@@ -0,0 +1,229 @@
+#include "shm_reader.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+
+namespace modbustt {
+
+namespace {
+
+// Tentatives de relecture d'un seqlock avant d'abandonner
+constexpr int kMaxReadRetries = 64;
+
+double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::chrono::system_clock::time_point fromNanoseconds(int64_t timestamp_ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp_ns)));
+}
+
+} // namespace
+
+SharedMemoryReader::~SharedMemoryReader() {
+    close();
+}
+
+bool SharedMemoryReader::open(const std::string& name) {
+    close();
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < sizeof(shm::Header)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    // magic est publié en dernier par l'écrivain: l'en-tête est complet s'il est présent
+    const auto* header = static_cast<const shm::Header*>(base);
+    if (header->magic.load(std::memory_order_acquire) != shm::kMagic ||
+        header->version != shm::kVersion || header->total_size > size) {
+        munmap(base, size);
+        return false;
+    }
+
+    base_ = static_cast<const uint8_t*>(base);
+    header_ = header;
+    mapped_size_ = size;
+    return true;
+}
+
+void SharedMemoryReader::close() {
+    if (!base_) return;
+    munmap(const_cast<uint8_t*>(base_), mapped_size_);
+    base_ = nullptr;
+    header_ = nullptr;
+    mapped_size_ = 0;
+}
+
+bool SharedMemoryReader::writer_closed() const {
+    return !header_ || header_->state.load(std::memory_order_acquire) == shm::WRITER_CLOSED;
+}
+
+int SharedMemoryReader::find(const std::string& collector_id, const std::string& point) const {
+    if (!header_) return -1;
+
+    uint32_t collector_count = header_->collector_count.load(std::memory_order_acquire);
+    const shm::CollectorName* names = collectorNames();
+    uint32_t collector = collector_count;
+    for (uint32_t i = 0; i < collector_count; ++i) {
+        if (collector_id == names[i].id) {
+            collector = i;
+            break;
+        }
+    }
+    if (collector == collector_count) return -1;
+
+    uint32_t entry_count = header_->entry_count.load(std::memory_order_acquire);
+    const shm::Entry* table = entries();
+    for (uint32_t i = 0; i < entry_count; ++i) {
+        if (table[i].collector == collector && point == table[i].point) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool SharedMemoryReader::read(int handle, double& value, int64_t* timestamp_ns) const {
+    if (!header_ || handle < 0 ||
+        static_cast<uint32_t>(handle) >= header_->entry_count.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    const shm::Entry& entry = entries()[handle];
+    for (int attempt = 0; attempt < kMaxReadRetries; ++attempt) {
+        uint64_t before = entry.sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        uint64_t bits = entry.value_bits.load(std::memory_order_relaxed);
+        int64_t timestamp = entry.timestamp_ns.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.sequence.load(std::memory_order_relaxed) != before) continue;
+
+        if (before == 0) return false;  // Publié mais jamais écrit
+        value = fromBits(bits);
+        if (timestamp_ns) *timestamp_ns = timestamp;
+        return true;
+    }
+    return false;
+}
+
+std::vector<TelemetryData> SharedMemoryReader::snapshot() const {
+    std::vector<TelemetryData> frames;
+    if (!header_) return frames;
+
+    uint32_t collector_count = header_->collector_count.load(std::memory_order_acquire);
+    const shm::CollectorName* names = collectorNames();
+    frames.resize(collector_count);
+    for (uint32_t i = 0; i < collector_count; ++i) {
+        frames[i].collector_id = names[i].id;
+    }
+
+    uint32_t entry_count = header_->entry_count.load(std::memory_order_acquire);
+    const shm::Entry* table = entries();
+    for (uint32_t i = 0; i < entry_count; ++i) {
+        double value;
+        int64_t timestamp_ns;
+        uint32_t collector = table[i].collector;
+        if (collector >= collector_count || !read(static_cast<int>(i), value, &timestamp_ns)) continue;
+        TelemetryData& frame = frames[collector];
+        frame.values[table[i].point] = value;
+        frame.timestamp = std::max(frame.timestamp, fromNanoseconds(timestamp_ns));
+    }
+    return frames;
+}
+
+SharedMemoryReadResult SharedMemoryReader::read_since(uint64_t cursor, size_t max_count) const {
+    SharedMemoryReadResult result;
+    result.next_cursor = cursor;
+    if (!header_) return result;
+
+    uint64_t head = header_->ring_head.load(std::memory_order_acquire);
+    uint64_t oldest = head >= header_->ring_capacity ? head - header_->ring_capacity + 1 : 1;
+    uint64_t next = cursor + 1;
+    if (next < oldest) {
+        // cursor == 0: premier appel, pas de trame manquée
+        if (cursor > 0) result.missed = oldest - next;
+        next = oldest;
+    }
+
+    TelemetryData frame;
+    for (; next <= head; ++next) {
+        if (max_count > 0 && result.frames.size() >= max_count) break;
+        if (readSlot(next, frame)) {
+            result.frames.push_back(std::move(frame));
+        } else {
+            result.missed++; // Écrasée pendant la lecture
+        }
+        result.next_cursor = next;
+    }
+    return result;
+}
+
+uint64_t SharedMemoryReader::head() const {
+    return header_ ? header_->ring_head.load(std::memory_order_acquire) : 0;
+}
+
+const shm::Entry* SharedMemoryReader::entries() const {
+    return reinterpret_cast<const shm::Entry*>(base_ + header_->table_offset);
+}
+
+const shm::CollectorName* SharedMemoryReader::collectorNames() const {
+    return reinterpret_cast<const shm::CollectorName*>(base_ + header_->collectors_offset);
+}
+
+bool SharedMemoryReader::readSlot(uint64_t cursor, TelemetryData& frame) const {
+    const auto& slot = *reinterpret_cast<const shm::RingSlotHeader*>(
+        base_ + header_->ring_offset + (cursor % header_->ring_capacity) * header_->slot_stride);
+    const auto* ring_values = reinterpret_cast<const shm::RingValue*>(&slot + 1);
+
+    // Copie locale des valeurs brutes, résolues en noms une fois la lecture validée
+    uint32_t indexes[256];
+    uint64_t bits[256];
+    uint32_t limit = std::min<uint32_t>(header_->ring_max_points, 256);
+
+    for (int attempt = 0; attempt < kMaxReadRetries; ++attempt) {
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        if (slot.cursor.load(std::memory_order_relaxed) != cursor) return false;
+        int64_t timestamp_ns = slot.timestamp_ns.load(std::memory_order_relaxed);
+        uint32_t collector = slot.collector.load(std::memory_order_relaxed);
+        uint32_t count = std::min(slot.count.load(std::memory_order_relaxed), limit);
+        for (uint32_t i = 0; i < count; ++i) {
+            indexes[i] = ring_values[i].entry.load(std::memory_order_relaxed);
+            bits[i] = ring_values[i].value_bits.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+
+        // Les noms sont publiés avant toute trame qui les référence
+        uint32_t collector_count = header_->collector_count.load(std::memory_order_acquire);
+        uint32_t entry_count = header_->entry_count.load(std::memory_order_acquire);
+        if (collector >= collector_count) return false;
+        const shm::Entry* table = entries();
+
+        frame.collector_id = collectorNames()[collector].id;
+        frame.timestamp = fromNanoseconds(timestamp_ns);
+        frame.values.clear();
+        for (uint32_t i = 0; i < count; ++i) {
+            if (indexes[i] < entry_count) {
+                frame.values[table[indexes[i]].point] = fromBits(bits[i]);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace modbustt
@@ -9,6 +9,7 @@ AcquisitionThread::AcquisitionThread(const ProductionLineConfig& config)
     , stopRequested_(false)
     , modbusContext_(nullptr)
     , connected_(false)
+    , dataQueue_(config.queueCapacity > 0 ? static_cast<size_t>(config.queueCapacity) : 1)
     , acquisitionPeriod_(config.acquisitionFrequencyMs) {
 }
 
@@ -95,19 +96,14 @@ void AcquisitionThread::setFrequency(int frequencyMs) {
 }
 
 bool AcquisitionThread::hasData() const {
-    std::lock_guard<std::mutex> lock(dataMutex_);
     return !dataQueue_.empty();
 }
 
 ModbusData AcquisitionThread::getData() {
-    std::lock_guard<std::mutex> lock(dataMutex_);
-    
-    if (dataQueue_.empty()) {
+    ModbusData data;
+    if (!dataQueue_.pop(data)) {
         return ModbusData(); // Retourne une structure vide
     }
-    
-    ModbusData data = dataQueue_.front();
-    dataQueue_.pop();
     return data;
 }
 
@@ -170,14 +166,14 @@ bool AcquisitionThread::connectToModbus() {
     modbus_set_byte_timeout(modbusContext_, 0, 500000); // 500ms
     
     if (modbus_connect(modbusContext_) == -1) {
-        LOG_ERROR("Connexion Modbus échouée pour " + config_.id + ": " + modbus_strerror(errno));
+        LOG_ERROR("Connexion Modbus échouée pour {}: {}", config_.id, modbus_strerror(errno));
         modbus_free(modbusContext_);
         modbusContext_ = nullptr;
         return false;
     }
     
     connected_ = true;
-    LOG_INFO("Connexion Modbus établie pour " + config_.id);
+    LOG_INFO("Connexion Modbus établie pour {}", config_.id);
     return true;
 }
 
@@ -198,7 +194,7 @@ bool AcquisitionThread::readRegisters() {
     std::map<std::string, double> values;
     bool success = true;
     
-    for (const auto& reg : config_.registers) {
+    for (const auto& reg : *config_.registers) {
         uint16_t rawValue[1];
         int result = -1;
         
@@ -221,7 +217,7 @@ bool AcquisitionThread::readRegisters() {
         }
         
         if (result == -1) {
-            LOG_ERROR("Erreur lecture registre " + std::to_string(reg.address) + " pour " + config_.id + ": " + modbus_strerror(errno));
+            LOG_ERROR("Erreur lecture registre {} pour {}: {}", reg.address, config_.id, modbus_strerror(errno));
             success = false;
             
             // Marquer la connexion comme fermée en cas d'erreur
@@ -238,16 +234,14 @@ bool AcquisitionThread::readRegisters() {
         // Créer et ajouter les données à la queue
         ModbusData data(config_.id, values);
         
-        {
-            std::lock_guard<std::mutex> lock(dataMutex_);
-            dataQueue_.push(data);
-            
-            // Limiter la taille de la queue pour éviter l'accumulation
-            while (dataQueue_.size() > 100) {
-                dataQueue_.pop();
+        // File pleine: l'échantillon est rejeté et comptabilisé
+        if (!dataQueue_.push(std::move(data))) {
+            // Journaliser aux puissances de deux pour ne pas inonder les logs
+            unsigned long long overflows = dataQueue_.overflowCount();
+            if ((overflows & (overflows - 1)) == 0) {
+                LOG_WARN("File de données pleine pour " + config_.id + ", échantillons perdus: " + std::to_string(overflows));
             }
         }
-        dataCondition_.notify_one();
     }
     
     return success;
@@ -0,0 +1,80 @@
+#include "ConfigDiff.h"
+#include <unordered_map>
+#include <map>
+
+namespace {
+
+bool sameRegisters(const RegisterTable& a, const RegisterTable& b) {
+    if (&a == &b) {
+        return true; // Table partagée d'un même profil
+    }
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].address != b[i].address || a[i].name != b[i].name || a[i].type != b[i].type ||
+            a[i].scale != b[i].scale || a[i].offset != b[i].offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameTuning(const ThreadTuning& a, const ThreadTuning& b) {
+    return a.cpuAffinity == b.cpuAffinity && a.schedPolicy == b.schedPolicy &&
+           a.schedPriority == b.schedPriority && a.prefaultStack == b.prefaultStack;
+}
+
+} // namespace
+
+std::vector<LineDiff> diffProductionLines(const std::vector<ProductionLineConfig>& previous,
+                                          const std::vector<ProductionLineConfig>& current) {
+    std::unordered_map<std::string, const ProductionLineConfig*> previousById;
+    std::unordered_map<std::string, const ProductionLineConfig*> currentById;
+    for (const auto& line : previous) {
+        if (line.enabled) previousById[line.id] = &line;
+    }
+    for (const auto& line : current) {
+        if (line.enabled) currentById[line.id] = &line;
+    }
+
+    // Les lignes d'un profil partagent leurs tables: une comparaison par paire de tables
+    std::map<std::pair<const RegisterTable*, const RegisterTable*>, bool> sameTables;
+
+    std::vector<LineDiff> diffs;
+    for (const auto& line : previous) {
+        if (line.enabled && currentById.find(line.id) == currentById.end()) {
+            LineDiff diff;
+            diff.id = line.id;
+            diff.line = line;
+            diff.removed = true;
+            diffs.push_back(std::move(diff));
+        }
+    }
+
+    for (const auto& line : current) {
+        if (!line.enabled) continue;
+
+        LineDiff diff;
+        auto it = previousById.find(line.id);
+        if (it == previousById.end()) {
+            diff.added = true;
+        } else {
+            const ProductionLineConfig& before = *it->second;
+            diff.rateChanged = before.acquisitionFrequencyMs != line.acquisitionFrequencyMs;
+            auto key = std::make_pair(before.registers.get(), line.registers.get());
+            auto known = sameTables.find(key);
+            if (known == sameTables.end()) {
+                known = sameTables.emplace(key, sameRegisters(*key.first, *key.second)).first;
+            }
+            diff.registersChanged = !known->second;
+            diff.endpointChanged = before.ip != line.ip || before.port != line.port || before.unitId != line.unitId;
+            diff.tuningChanged = !sameTuning(before.threadTuning, line.threadTuning);
+            if (!diff.rateChanged && !diff.registersChanged && !diff.requiresRestart()) continue;
+        }
+        diff.id = line.id;
+        diff.line = line;
+        diffs.push_back(std::move(diff));
+    }
+    return diffs;
+}
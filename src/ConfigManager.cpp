@@ -1,33 +1,58 @@
 #include "ConfigManager.h"
 #include "Logger.h"
 #include <fstream>
+#include <stdexcept>
 #include <sys/stat.h>
 
-ConfigManager::ConfigManager() : lastModificationTime_(0) {
+nlohmann::json ConfigSnapshot::getExporterConfig(const std::string& name) const {
+    if (exporters.is_object() && exporters.contains(name)) {
+        return exporters[name];
+    }
+    return nlohmann::json::object();
+}
+
+ConfigManager::ConfigManager()
+    : snapshot_(std::make_shared<const ConfigSnapshot>()), lastModificationTime_(0) {
 }
 
 bool ConfigManager::loadConfig(const std::string& configFile) {
     std::lock_guard<std::mutex> lock(configMutex_);
     
     try {
+        // Nouvel instantané construit à part: en cas d'erreur, l'instantané courant reste intact
+        auto config = std::make_shared<ConfigSnapshot>();
         configFilePath_ = configFile;
-        YAML::Node config = YAML::LoadFile(configFile);
+        YAML::Node root = YAML::LoadFile(configFile);
         
         // Parse MQTT configuration
-        if (config["mqtt"]) {
-            parseMqttConfig(config["mqtt"]);
+        if (root["mqtt"]) {
+            parseMqttConfig(root["mqtt"], config->mqtt);
         } else {
             LOG_ERROR("Configuration MQTT manquante dans le fichier de configuration");
             return false;
         }
         
+        // Parse exporters configuration
+        config->exporters = root["exporters"] ? yamlToJson(root["exporters"]) : nlohmann::json::object();
+        
+        // Parse logging configuration
+        parseLoggingConfig(root["logging"], config->logging);
+        
+        // Parse threading configuration (avant les lignes, qui en héritent)
+        parseThreadingConfig(root["threading"], config->threading);
+        
+        // Parse device profiles (avant les lignes, qui les référencent)
+        parseDeviceProfiles(root["device_profiles"], *config);
+        
         // Parse production lines configuration
-        if (config["production_lines"]) {
-            parseProductionLines(config["production_lines"]);
+        if (root["production_lines"]) {
+            parseProductionLines(root["production_lines"], *config);
         } else {
             LOG_WARN("Aucune ligne de production configurée");
         }
         
+        publish(std::move(config));
+        
         // Mettre à jour le timestamp de dernière modification
         lastModificationTime_ = getFileModificationTime(configFile);
         
@@ -47,26 +72,56 @@ bool ConfigManager::reloadConfig() {
     return loadConfig(configFilePath_);
 }
 
-const std::vector<ProductionLineConfig>& ConfigManager::getProductionLines() const {
-    std::lock_guard<std::mutex> lock(configMutex_);
-    return productionLines_;
+std::shared_ptr<const ConfigSnapshot> ConfigManager::getSnapshot() const {
+    return std::atomic_load(&snapshot_);
 }
 
-const MqttConfig& ConfigManager::getMqttConfig() const {
-    std::lock_guard<std::mutex> lock(configMutex_);
-    return mqttConfig_;
+std::vector<ProductionLineConfig> ConfigManager::getProductionLines() const {
+    return getSnapshot()->productionLines;
 }
 
-bool ConfigManager::updateLineConfig(const std::string& lineId, const ProductionLineConfig& newConfig) {
-    std::lock_guard<std::mutex> lock(configMutex_);
-    
-    for (auto& line : productionLines_) {
+MqttConfig ConfigManager::getMqttConfig() const {
+    return getSnapshot()->mqtt;
+}
+
+ThreadingConfig ConfigManager::getThreadingConfig() const {
+    return getSnapshot()->threading;
+}
+
+LoggingConfig ConfigManager::getLoggingConfig() const {
+    return getSnapshot()->logging;
+}
+
+nlohmann::json ConfigManager::getExporterConfig(const std::string& name) const {
+    return getSnapshot()->getExporterConfig(name);
+}
+
+void ConfigManager::publish(std::shared_ptr<ConfigSnapshot> snapshot) {
+    snapshot->version = getSnapshot()->version + 1;
+    std::atomic_store(&snapshot_, std::shared_ptr<const ConfigSnapshot>(std::move(snapshot)));
+}
+
+// Copie l'instantané courant, modifie la ligne lineId et publie la copie (configMutex_ tenu)
+template <typename Update>
+bool ConfigManager::updateLine(const std::string& lineId, Update&& update) {
+    auto config = std::make_shared<ConfigSnapshot>(*getSnapshot());
+    for (auto& line : config->productionLines) {
         if (line.id == lineId) {
-            line = newConfig;
-            LOG_INFO("Configuration mise à jour pour la ligne: " + lineId);
+            update(line);
+            publish(std::move(config));
             return true;
         }
     }
+    return false;
+}
+
+bool ConfigManager::updateLineConfig(const std::string& lineId, const ProductionLineConfig& newConfig) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    
+    if (updateLine(lineId, [&newConfig](ProductionLineConfig& line) { line = newConfig; })) {
+        LOG_INFO("Configuration mise à jour pour la ligne: " + lineId);
+        return true;
+    }
     
     LOG_WARN("Ligne non trouvée pour mise à jour: " + lineId);
     return false;
@@ -75,12 +130,9 @@ bool ConfigManager::updateLineConfig(const std::string& lineId, const Production
 bool ConfigManager::enableLine(const std::string& lineId, bool enable) {
     std::lock_guard<std::mutex> lock(configMutex_);
     
-    for (auto& line : productionLines_) {
-        if (line.id == lineId) {
-            line.enabled = enable;
-            LOG_INFO("Ligne " + lineId + (enable ? " activée" : " désactivée"));
-            return true;
-        }
+    if (updateLine(lineId, [enable](ProductionLineConfig& line) { line.enabled = enable; })) {
+        LOG_INFO("Ligne " + lineId + (enable ? " activée" : " désactivée"));
+        return true;
     }
     
     LOG_WARN("Ligne non trouvée: " + lineId);
@@ -90,12 +142,9 @@ bool ConfigManager::enableLine(const std::string& lineId, bool enable) {
 bool ConfigManager::setLineFrequency(const std::string& lineId, int frequencyMs) {
     std::lock_guard<std::mutex> lock(configMutex_);
     
-    for (auto& line : productionLines_) {
-        if (line.id == lineId) {
-            line.acquisitionFrequencyMs = frequencyMs;
-            LOG_INFO("Fréquence mise à jour pour la ligne " + lineId + ": " + std::to_string(frequencyMs) + "ms");
-            return true;
-        }
+    if (updateLine(lineId, [frequencyMs](ProductionLineConfig& line) { line.acquisitionFrequencyMs = frequencyMs; })) {
+        LOG_INFO("Fréquence mise à jour pour la ligne " + lineId + ": " + std::to_string(frequencyMs) + "ms");
+        return true;
     }
     
     LOG_WARN("Ligne non trouvée: " + lineId);
@@ -111,50 +160,204 @@ void ConfigManager::markConfigAsRead() {
     lastModificationTime_ = getFileModificationTime(configFilePath_);
 }
 
-void ConfigManager::parseProductionLines(const YAML::Node& node) {
-    productionLines_.clear();
+void ConfigManager::parseDeviceProfiles(const YAML::Node& node, ConfigSnapshot& config) {
+    if (!node) {
+        return;
+    }
+    
+    for (const auto& pair : node) {
+        const YAML::Node& profileNode = pair.second;
+        DeviceProfile profile;
+        
+        profile.name = pair.first.as<std::string>();
+        profile.port = profileNode["port"].as<int>(502);
+        profile.unitId = profileNode["unit_id"].as<int>(1);
+        profile.acquisitionFrequencyMs = profileNode["acquisition_frequency_ms"].as<int>(200);
+        profile.queueCapacity = profileNode["queue_capacity"].as<int>(100);
+        profile.threadTuning = parseThreadTuning(profileNode["threading"], config.threading.collectors);
+        profile.registers = parseRegisters(profileNode["registers"]);
+        
+        LOG_INFO("Profil d'équipement: " + profile.name + " (" + std::to_string(profile.registers->size()) + " registres)");
+        config.deviceProfiles[profile.name] = std::move(profile);
+    }
+}
+
+void ConfigManager::parseProductionLines(const YAML::Node& node, ConfigSnapshot& config) {
+    config.productionLines.reserve(node.size());
     
     for (const auto& lineNode : node) {
         ProductionLineConfig line;
         
         line.id = lineNode["id"].as<std::string>();
         line.ip = lineNode["ip"].as<std::string>();
-        line.port = lineNode["port"].as<int>(502);
-        line.unitId = lineNode["unit_id"].as<int>(1);
-        line.acquisitionFrequencyMs = lineNode["acquisition_frequency_ms"].as<int>(200);
-        line.enabled = lineNode["enabled"].as<bool>(true);
         
-        // Parse registers
-        if (lineNode["registers"]) {
-            for (const auto& regNode : lineNode["registers"]) {
-                ModbusRegister reg;
-                reg.address = regNode["address"].as<int>();
-                reg.name = regNode["name"].as<std::string>();
-                reg.type = regNode["type"].as<std::string>();
-                reg.scale = regNode["scale"].as<double>(1.0);
-                reg.offset = regNode["offset"].as<double>(0.0);
-                
-                line.registers.push_back(reg);
+        // Profil référencé: valeurs par défaut de la ligne, surchargeables champ par champ
+        DeviceProfile defaults;
+        defaults.threadTuning = config.threading.collectors;
+        if (lineNode["profile"]) {
+            line.profile = lineNode["profile"].as<std::string>();
+            auto it = config.deviceProfiles.find(line.profile);
+            if (it == config.deviceProfiles.end()) {
+                throw std::runtime_error("profil d'équipement inconnu '" + line.profile + "' pour la ligne " + line.id);
             }
+            defaults = it->second;
         }
         
-        productionLines_.push_back(line);
-        LOG_INFO("Ligne de production configurée: " + line.id + " (" + line.ip + ":" + std::to_string(line.port) + ")");
+        line.port = lineNode["port"].as<int>(defaults.port);
+        line.unitId = lineNode["unit_id"].as<int>(defaults.unitId);
+        line.acquisitionFrequencyMs = lineNode["acquisition_frequency_ms"].as<int>(defaults.acquisitionFrequencyMs);
+        line.queueCapacity = lineNode["queue_capacity"].as<int>(defaults.queueCapacity);
+        line.enabled = lineNode["enabled"].as<bool>(true);
+        
+        // Réglages du thread: valeurs par défaut des collecteurs (ou du profil), surchargeables par ligne
+        line.threadTuning = parseThreadTuning(lineNode["threading"], defaults.threadTuning);
+        line.threadTuning.name = "acq-" + line.id;
+        
+        // Registres propres à la ligne, sinon table partagée du profil
+        line.registers = lineNode["registers"] ? parseRegisters(lineNode["registers"]) : defaults.registers;
+        
+        config.productionLines.push_back(std::move(line));
+        const auto& added = config.productionLines.back();
+        LOG_DEBUG("Ligne de production configurée: {} ({}:{})", added.id, added.ip, added.port);
+    }
+    
+    LOG_INFO("Lignes de production configurées: " + std::to_string(config.productionLines.size()));
+}
+
+std::shared_ptr<const RegisterTable> ConfigManager::parseRegisters(const YAML::Node& node) {
+    if (!node) {
+        return emptyRegisterTable();
+    }
+    
+    auto registers = std::make_shared<RegisterTable>();
+    registers->reserve(node.size());
+    for (const auto& regNode : node) {
+        ModbusRegister reg;
+        reg.address = regNode["address"].as<int>();
+        reg.name = regNode["name"].as<std::string>();
+        reg.type = regNode["type"].as<std::string>();
+        reg.scale = regNode["scale"].as<double>(1.0);
+        reg.offset = regNode["offset"].as<double>(0.0);
+        
+        registers->push_back(reg);
+    }
+    return registers;
+}
+
+void ConfigManager::parseMqttConfig(const YAML::Node& node, MqttConfig& mqtt) {
+    mqtt.broker = node["broker"].as<std::string>();
+    mqtt.port = node["port"].as<int>(1883);
+    mqtt.clientId = node["client_id"].as<std::string>();
+    mqtt.username = node["username"].as<std::string>("");
+    mqtt.password = node["password"].as<std::string>("");
+    mqtt.publishTopic = node["publish_topic"].as<std::string>("supervision/data");
+    mqtt.commandTopic = node["command_topic"].as<std::string>("supervision/commands");
+    mqtt.publishFrequencyMs = node["publish_frequency_ms"].as<int>(800);
+    mqtt.qos = node["qos"].as<int>(1);
+    mqtt.publishMode = node["publish_mode"].as<std::string>("latest");
+    mqtt.lingerMs = node["linger_ms"].as<int>(0);
+    mqtt.maxBatchBytes = node["max_batch_bytes"].as<int>(64 * 1024);
+    mqtt.maxInFlight = node["max_in_flight"].as<int>(64);
+    
+    if (mqtt.publishMode != "latest" && mqtt.publishMode != "timeseries") {
+        LOG_WARN("Mode de publication inconnu '" + mqtt.publishMode + "', utilisation de 'latest'");
+        mqtt.publishMode = "latest";
+    }
+    
+    LOG_INFO("Configuration MQTT: " + mqtt.broker + ":" + std::to_string(mqtt.port));
+}
+
+void ConfigManager::parseThreadingConfig(const YAML::Node& node, ThreadingConfig& threading) {
+    threading = ThreadingConfig();
+    
+    if (node) {
+        threading.lockMemory = node["lock_memory"].as<bool>(false);
+        threading.collectors = parseThreadTuning(node["collectors"], ThreadTuning());
+        threading.publisher = parseThreadTuning(node["publisher"], ThreadTuning());
+        threading.config = parseThreadTuning(node["config"], ThreadTuning());
     }
+    
+    threading.collectors.prefaultStack = threading.lockMemory;
+    threading.publisher.prefaultStack = threading.lockMemory;
+    threading.config.prefaultStack = threading.lockMemory;
+    threading.publisher.name = "publisher";
+    threading.config.name = "config";
 }
 
-void ConfigManager::parseMqttConfig(const YAML::Node& node) {
-    mqttConfig_.broker = node["broker"].as<std::string>();
-    mqttConfig_.port = node["port"].as<int>(1883);
-    mqttConfig_.clientId = node["client_id"].as<std::string>();
-    mqttConfig_.username = node["username"].as<std::string>("");
-    mqttConfig_.password = node["password"].as<std::string>("");
-    mqttConfig_.publishTopic = node["publish_topic"].as<std::string>("supervision/data");
-    mqttConfig_.commandTopic = node["command_topic"].as<std::string>("supervision/commands");
-    mqttConfig_.publishFrequencyMs = node["publish_frequency_ms"].as<int>(800);
-    mqttConfig_.qos = node["qos"].as<int>(1);
+void ConfigManager::parseLoggingConfig(const YAML::Node& node, LoggingConfig& logging) {
+    logging = LoggingConfig();
+    if (!node) {
+        return;
+    }
+    
+    logging.level = node["level"].as<std::string>("INFO");
+    logging.file = node["file"].as<std::string>("supervision.log");
+    logging.console = node["console"].as<bool>(true);
+    logging.async = node["async"].as<bool>(false);
+    logging.queueSize = node["queue_size"].as<int>(8192);
+    logging.overflow = node["overflow"].as<std::string>("drop");
+    logging.rateLimitBurst = node["rate_limit_burst"].as<int>(5);
+    logging.rateLimitIntervalS = node["rate_limit_interval_s"].as<int>(60);
+    
+    if (logging.overflow != "drop" && logging.overflow != "block") {
+        LOG_WARN("Politique de débordement des logs inconnue '" + logging.overflow + "', utilisation de 'drop'");
+        logging.overflow = "drop";
+    }
+}
+
+ThreadTuning ConfigManager::parseThreadTuning(const YAML::Node& node, const ThreadTuning& defaults) const {
+    ThreadTuning tuning = defaults;
+    if (!node) {
+        return tuning;
+    }
+    
+    if (node["cpu_affinity"]) {
+        tuning.cpuAffinity = node["cpu_affinity"].as<std::vector<int>>();
+    }
+    tuning.schedPolicy = node["sched_policy"].as<std::string>(defaults.schedPolicy);
+    tuning.schedPriority = node["sched_priority"].as<int>(defaults.schedPriority);
     
-    LOG_INFO("Configuration MQTT: " + mqttConfig_.broker + ":" + std::to_string(mqttConfig_.port));
+    if (tuning.schedPolicy == "fifo" && (tuning.schedPriority < 1 || tuning.schedPriority > 99)) {
+        LOG_WARN("Priorité SCHED_FIFO hors plage (1-99): " + std::to_string(tuning.schedPriority) + ", utilisation de 1");
+        tuning.schedPriority = 1;
+    }
+    
+    return tuning;
+}
+
+nlohmann::json ConfigManager::yamlToJson(const YAML::Node& node) {
+    switch (node.Type()) {
+        case YAML::NodeType::Map: {
+            nlohmann::json object = nlohmann::json::object();
+            for (const auto& pair : node) {
+                object[pair.first.as<std::string>()] = yamlToJson(pair.second);
+            }
+            return object;
+        }
+        case YAML::NodeType::Sequence: {
+            nlohmann::json array = nlohmann::json::array();
+            for (const auto& item : node) {
+                array.push_back(yamlToJson(item));
+            }
+            return array;
+        }
+        case YAML::NodeType::Scalar: {
+            // Scalaire entre guillemets ("!") ou marqué !!str: toujours une chaîne ("007", "true")
+            if (node.Tag() == "!" || node.Tag() == "tag:yaml.org,2002:str") {
+                return node.Scalar();
+            }
+            // Les scalaires nus ne sont pas typés: essayer entier, réel, booléen puis chaîne
+            long long integer;
+            double real;
+            bool boolean;
+            if (YAML::convert<long long>::decode(node, integer)) return integer;
+            if (YAML::convert<double>::decode(node, real)) return real;
+            if (YAML::convert<bool>::decode(node, boolean)) return boolean;
+            return node.as<std::string>();
+        }
+        default:
+            return nullptr;
+    }
 }
 
 std::time_t ConfigManager::getFileModificationTime(const std::string& filepath) const {
@@ -96,6 +96,7 @@ void ConfigThread::delivery_complete(mqtt::delivery_token_ptr token) {
 }
 
 void ConfigThread::threadFunction() {
+    applyThreadTuning(threadTuning_);
     LOG_INFO("Thread de configuration en cours d'exécution");
     
     while (!stopRequested_) {
@@ -0,0 +1,256 @@
+#include "ConfigWatcher.h"
+#include "Logger.h"
+#include <sys/stat.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace {
+
+// Période de vérification sans inotify
+constexpr int kPollIntervalMs = 1000;
+
+// Profondeur maximale d'une chaîne de liens symboliques suivie
+constexpr int kMaxSymlinkDepth = 8;
+
+std::string dirName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) return ".";
+    if (slash == 0) return "/";
+    return path.substr(0, slash);
+}
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool isSymlink(const std::string& path) {
+    struct stat info;
+    return lstat(path.c_str(), &info) == 0 && S_ISLNK(info.st_mode);
+}
+
+void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+} // namespace
+
+bool ConfigWatcher::Fingerprint::operator==(const Fingerprint& other) const {
+    return exists == other.exists && device == other.device && inode == other.inode &&
+           size == other.size && mtimeNs == other.mtimeNs;
+}
+
+ConfigWatcher::ConfigWatcher(std::chrono::milliseconds debounce) : debounce_(debounce) {
+    // Créé dès la construction: wakeup() reste valide avant start()
+    if (pipe(wakePipe_) == 0) {
+        setNonBlocking(wakePipe_[0]);
+        setNonBlocking(wakePipe_[1]);
+    }
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    if (inotifyFd_ >= 0) close(inotifyFd_);
+    if (wakePipe_[0] >= 0) close(wakePipe_[0]);
+    if (wakePipe_[1] >= 0) close(wakePipe_[1]);
+}
+
+bool ConfigWatcher::start(const std::string& filepath) {
+    filepath_ = filepath;
+    last_ = readFingerprint();
+
+#ifdef __linux__
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0) {
+        LOG_WARN("inotify indisponible (" + std::string(strerror(errno)) +
+                 "), vérification de la configuration chaque seconde");
+        return false;
+    }
+    armWatches();
+    LOG_INFO("Surveillance inotify de la configuration: " + filepath_);
+    return true;
+#else
+    LOG_INFO("Vérification de la configuration chaque seconde: " + filepath_);
+    return false;
+#endif
+}
+
+void ConfigWatcher::wakeup() {
+    if (wakePipe_[1] >= 0) {
+        char byte = 1;
+        ssize_t ignored = write(wakePipe_[1], &byte, 1);
+        (void)ignored;
+    }
+}
+
+bool ConfigWatcher::waitForChange() {
+    using Clock = std::chrono::steady_clock;
+    bool pending = false;
+    Clock::time_point lastEvent;
+
+    for (;;) {
+        int timeoutMs = -1;
+        if (pending) {
+            auto quiet = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - lastEvent);
+            timeoutMs = static_cast<int>(std::max<int64_t>(0, (debounce_ - quiet).count()));
+        } else if (inotifyFd_ < 0) {
+            timeoutMs = kPollIntervalMs;
+        }
+
+        struct pollfd fds[2];
+        nfds_t count = 0;
+        fds[count++] = {wakePipe_[0], POLLIN, 0};
+        if (inotifyFd_ >= 0) fds[count++] = {inotifyFd_, POLLIN, 0};
+
+        int ready = poll(fds, count, timeoutMs);
+        if (ready < 0) {
+            // EINTR: un signal a pu demander l'arrêt, l'appelant vérifie
+            return false;
+        }
+        if (fds[0].revents & POLLIN) {
+            char buffer[64];
+            while (read(wakePipe_[0], buffer, sizeof(buffer)) > 0) {
+            }
+            return false;
+        }
+        if (count > 1 && (fds[1].revents & POLLIN)) {
+            if (readEvents()) {
+                pending = true;
+                lastEvent = Clock::now();
+            }
+            continue;
+        }
+        if (ready == 0 && (pending || inotifyFd_ < 0)) {
+            pending = false;
+            if (checkChanged()) return true;
+        }
+    }
+}
+
+bool ConfigWatcher::checkChanged() {
+    Fingerprint current = readFingerprint();
+    // Fichier absent entre deux étapes d'un renommage: attendre l'événement suivant
+    if (!current.exists || current == last_) {
+        return false;
+    }
+    last_ = current;
+    // La cible d'un lien symbolique a pu changer de répertoire
+    if (inotifyFd_ >= 0) armWatches();
+    return true;
+}
+
+ConfigWatcher::Fingerprint ConfigWatcher::readFingerprint() const {
+    Fingerprint fingerprint;
+    struct stat info;
+    if (stat(filepath_.c_str(), &info) != 0) {
+        return fingerprint;
+    }
+    fingerprint.exists = true;
+    fingerprint.device = info.st_dev;
+    fingerprint.inode = info.st_ino;
+    fingerprint.size = info.st_size;
+#ifdef __APPLE__
+    fingerprint.mtimeNs = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    fingerprint.mtimeNs = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    return fingerprint;
+}
+
+void ConfigWatcher::armWatches() {
+#ifdef __linux__
+    // Un répertoire déjà surveillé garde son descripteur: seuls les anciens sont retirés
+    std::unordered_map<int, std::vector<std::string>> previous;
+    previous.swap(watchedNames_);
+
+    // Chaque maillon de la chaîne de liens, puis le fichier réel
+    std::string current = filepath_;
+    for (int depth = 0; depth < kMaxSymlinkDepth; ++depth) {
+        watchEntry(current);
+        char target[PATH_MAX];
+        ssize_t length = readlink(current.c_str(), target, sizeof(target) - 1);
+        if (length < 0) break;
+        std::string next(target, static_cast<size_t>(length));
+        current = next[0] == '/' ? next : dirName(current) + "/" + next;
+    }
+    char resolved[PATH_MAX];
+    if (realpath(filepath_.c_str(), resolved)) {
+        watchEntry(resolved);
+    }
+
+    for (const auto& pair : previous) {
+        if (watchedNames_.find(pair.first) == watchedNames_.end()) {
+            inotify_rm_watch(inotifyFd_, pair.first);
+        }
+    }
+#endif
+}
+
+void ConfigWatcher::watchEntry(const std::string& path) {
+#ifdef __linux__
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE |
+                          IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+    std::string dir = dirName(path);
+    int wd = inotify_add_watch(inotifyFd_, dir.c_str(), mask);
+    if (wd < 0) {
+        LOG_WARN("inotify: impossible de surveiller " + dir + ": " + std::string(strerror(errno)));
+        return;
+    }
+    watchedNames_[wd].push_back(baseName(path));
+
+    // Répertoire atteint par un lien (..data -> ..2024_01_01 chez Kubernetes):
+    // son remplacement est un renommage dans le répertoire parent
+    if (isSymlink(dir)) {
+        int parentWd = inotify_add_watch(inotifyFd_, dirName(dir).c_str(), mask);
+        if (parentWd >= 0) watchedNames_[parentWd].push_back(baseName(dir));
+    }
+#else
+    (void)path;
+#endif
+}
+
+bool ConfigWatcher::readEvents() {
+    bool relevant = false;
+#ifdef __linux__
+    alignas(struct inotify_event) char buffer[4096];
+    bool rearm = false;
+    for (;;) {
+        ssize_t length = read(inotifyFd_, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (char* cursor = buffer; cursor < buffer + length;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(cursor);
+            cursor += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                relevant = true;
+                continue;
+            }
+            auto it = watchedNames_.find(event->wd);
+            if (it == watchedNames_.end()) {
+                continue; // Surveillance retirée par armWatches()
+            }
+            if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+                // Répertoire surveillé supprimé ou déplacé (ancienne cible d'un lien)
+                relevant = true;
+                rearm = true;
+            } else if (event->len > 0 &&
+                       std::find(it->second.begin(), it->second.end(), event->name) != it->second.end()) {
+                relevant = true;
+            }
+        }
+    }
+    if (rearm) armWatches();
+#endif
+    return relevant;
+}
@@ -1,31 +1,321 @@
 #include "Logger.h"
 #include <iostream>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unordered_map>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+namespace {
+
+// Nombre maximal de lignes écrites par appel système en mode asynchrone
+constexpr size_t kMaxBatchRecords = 1024;
+
+// Délai maximal avant que le thread d'écriture ne remarque une ligne sans notification
+constexpr auto kWriterIdleTimeout = std::chrono::milliseconds(50);
+
+// Nombre maximal de couples site/contexte suivis par la limitation de débit
+constexpr size_t kMaxRateStates = 4096;
+
+// Période de recherche des résumés de messages supprimés à écrire
+constexpr auto kRateSweepPeriod = std::chrono::seconds(1);
+
+// Contexte du thread courant (identifiant du collecteur)
+thread_local std::string threadContext;
+
+int64_t steadyMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* baseName(const char* path) {
+    const char* slash = std::strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+void writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = ::write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
+
+} // namespace
+
+thread_local std::unordered_map<const LogSite*, std::shared_ptr<Logger::RateState>> Logger::rateCache_;
 
 Logger& Logger::getInstance() {
     static Logger instance;
     return instance;
 }
 
+Logger::~Logger() {
+    shutdown();
+    if (logFd_ >= 0) {
+        ::close(logFd_);
+    }
+}
+
 void Logger::setLogLevel(LogLevel level) {
-    std::lock_guard<std::mutex> lock(logMutex_);
     currentLevel_ = level;
 }
 
 void Logger::setLogFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Erreur: Impossible d'ouvrir le fichier de log: " << filename << std::endl;
+    }
     std::lock_guard<std::mutex> lock(logMutex_);
-    if (logFile_) {
-        logFile_->close();
+    if (logFd_ >= 0) {
+        ::close(logFd_);
     }
-    logFile_ = std::make_unique<std::ofstream>(filename, std::ios::app);
-    if (!logFile_->is_open()) {
-        std::cerr << "Erreur: Impossible d'ouvrir le fichier de log: " << filename << std::endl;
-        logFile_.reset();
+    logFd_ = fd;
+}
+
+void Logger::setConsoleOutput(bool enabled) {
+    std::lock_guard<std::mutex> lock(logMutex_);
+    logToConsole_ = enabled;
+}
+
+void Logger::enableAsync(size_t capacity, LogOverflowPolicy policy) {
+    if (writerThread_) return;
+
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    ring_.reset(new Record[size]);
+    for (size_t i = 0; i < size; ++i) {
+        ring_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask_ = size - 1;
+    enqueuePos_ = 0;
+    dequeuePos_ = 0;
+    writtenPos_ = 0;
+    overflowPolicy_ = policy;
+    stopWriter_ = false;
+
+    writerThread_ = std::make_unique<std::thread>(&Logger::writerThreadFunction, this);
+    async_.store(true, std::memory_order_release);
+}
+
+void Logger::flush() {
+    if (!async_) return;
+
+    size_t target = enqueuePos_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(writerMutex_);
+    writerCv_.notify_one();
+    flushedCv_.wait_for(lock, std::chrono::seconds(5), [this, target] {
+        return writtenPos_.load(std::memory_order_acquire) >= target || !writerThread_;
+    });
+}
+
+void Logger::shutdown() {
+    // Résumés en attente écrits tant que le thread d'écriture tourne
+    flushSuppressed(true);
+    if (!writerThread_) return;
+
+    // Les nouveaux messages repassent en écriture directe, le thread vide la file
+    async_.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        stopWriter_ = true;
+    }
+    writerCv_.notify_all();
+    if (writerThread_->joinable()) {
+        writerThread_->join();
+    }
+    writerThread_.reset();
+
+    // Lignes d'un producteur qui a vu le mode asynchrone juste avant l'arrêt
+    std::lock_guard<std::mutex> lock(logMutex_);
+    while (dequeue([this](const Record& record) { writeDirect(record.level, record.text, record.length); })) {
     }
 }
 
+void Logger::installCrashHandlers() {
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = &Logger::crashSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESETHAND;   // Le signal relancé applique le comportement par défaut
+    for (int signal : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+        sigaction(signal, &action, nullptr);
+    }
+}
+
+void Logger::setRateLimit(uint32_t burst, std::chrono::seconds interval) {
+    rateLimitBurst_ = burst;
+    rateLimitIntervalMs_ = std::chrono::duration_cast<std::chrono::milliseconds>(interval).count();
+}
+
+void Logger::setThreadContext(const std::string& context) {
+    if (context != threadContext) {
+        // Les états en cache appartiennent à l'ancien contexte
+        rateCache_.clear();
+    }
+    threadContext = context;
+}
+
+const std::string& Logger::getThreadContext() {
+    return threadContext;
+}
+
+void Logger::logAt(const LogSite& site, LogLevel level, const std::string& message) {
+    if (level < currentLevel_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    uint32_t burst = rateLimitBurst_.load(std::memory_order_relaxed);
+    if (burst == 0) {
+        log(level, message);
+        return;
+    }
+
+    int64_t intervalMs = rateLimitIntervalMs_.load(std::memory_order_relaxed);
+    int64_t nowMs = steadyMillis();
+    if (nowMs >= nextRateSweepMs_.load(std::memory_order_relaxed)) {
+        sweepRateStates(nowMs);
+    }
+
+    // État partagé par site et par contexte: un collecteur ne masque pas les
+    // messages d'un autre, et les résumés survivent au thread qui les a produits
+    RateState& state = rateStateFor(site, nowMs);
+    int64_t windowStart = state.windowStartMs.load(std::memory_order_relaxed);
+    if (nowMs - windowStart >= intervalMs &&
+        state.windowStartMs.compare_exchange_strong(windowStart, nowMs, std::memory_order_relaxed)) {
+        // Un seul thread rouvre l'intervalle et écrit le résumé du précédent
+        state.count.store(0, std::memory_order_relaxed);
+        uint64_t suppressed = state.suppressed.exchange(0);
+        if (suppressed > 0) {
+            Summary summary = makeSummary(state, suppressed);
+            log(summary.level, summary.message);
+        }
+        windowStart = nowMs;
+    }
+
+    uint32_t count = state.count.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (count > burst) {
+        state.level.store(level, std::memory_order_relaxed);
+        state.suppressed.fetch_add(1);
+        suppressed_++;
+        // État retiré par un balayage concurrent: ce message n'a peut-être pas été résumé
+        if (state.retired.load()) {
+            uint64_t suppressed = state.suppressed.exchange(0);
+            if (suppressed > 0) {
+                Summary summary = makeSummary(state, suppressed);
+                log(summary.level, summary.message);
+            }
+        }
+        return;
+    }
+
+    log(level, message);
+    if (count == burst) {
+        // Prévenir une seule fois que la suite sera résumée
+        int64_t remainingMs = intervalMs - (nowMs - windowStart);
+        log(level, "Messages similaires suivants supprimés pendant " + std::to_string((remainingMs + 999) / 1000) +
+                   " s (" + baseName(site.file) + ":" + std::to_string(site.line) +
+                   (threadContext.empty() ? "" : ", " + threadContext) + ")");
+    }
+}
+
+Logger::RateState& Logger::rateStateFor(const LogSite& site, int64_t nowMs) {
+    auto cached = rateCache_.find(&site);
+    if (cached != rateCache_.end() && !cached->second->retired.load(std::memory_order_relaxed)) {
+        return *cached->second;
+    }
+
+    // Premier message du site dans ce contexte, ou état retiré par un balayage
+    std::vector<Summary> summaries;
+    std::shared_ptr<RateState> state;
+    {
+        std::lock_guard<std::mutex> lock(rateMutex_);
+        if (rateStates_.size() >= kMaxRateStates) {
+            summaries = collectSummaries(nowMs, true);
+        }
+        std::shared_ptr<RateState>& entry = rateStates_[RateKey{&site, threadContext}];
+        if (!entry) {
+            entry = std::make_shared<RateState>();
+            entry->site = &site;
+            entry->context = threadContext;
+            entry->windowStartMs.store(nowMs, std::memory_order_relaxed);
+        }
+        state = entry;
+    }
+    for (const auto& summary : summaries) {
+        log(summary.level, summary.message);
+    }
+    RateState& result = *state;
+    rateCache_[&site] = std::move(state);
+    return result;
+}
+
+void Logger::sweepRateStates(int64_t nowMs) {
+    // Un seul thread balaie; les autres ne l'attendent pas
+    std::vector<Summary> summaries;
+    {
+        std::unique_lock<std::mutex> lock(rateMutex_, std::try_to_lock);
+        if (!lock.owns_lock()) return;
+        summaries = collectSummaries(nowMs, false);
+    }
+    for (const auto& summary : summaries) {
+        log(summary.level, summary.message);
+    }
+}
+
+void Logger::flushSuppressed(bool force) {
+    std::vector<Summary> summaries;
+    {
+        std::lock_guard<std::mutex> lock(rateMutex_);
+        summaries = collectSummaries(steadyMillis(), force);
+    }
+    for (const auto& summary : summaries) {
+        log(summary.level, summary.message);
+    }
+}
+
+std::vector<Logger::Summary> Logger::collectSummaries(int64_t nowMs, bool force) {
+    // Appelée avec rateMutex_ verrouillé; force vide la table (arrêt, table pleine)
+    std::vector<Summary> summaries;
+    int64_t intervalMs = rateLimitIntervalMs_.load(std::memory_order_relaxed);
+    for (auto it = rateStates_.begin(); it != rateStates_.end();) {
+        RateState& state = *it->second;
+        bool expired = force || nowMs - state.windowStartMs.load(std::memory_order_relaxed) >= intervalMs;
+        if (!expired) {
+            ++it;
+            continue;
+        }
+        // Site revenu au calme: retiré pour borner la table. Retiré avant de relever
+        // le compteur, pour qu'un message supprimé entre-temps soit résumé par logAt()
+        state.retired.store(true);
+        uint64_t suppressed = state.suppressed.exchange(0);
+        if (suppressed > 0) {
+            summaries.push_back(makeSummary(state, suppressed));
+        }
+        it = rateStates_.erase(it);
+    }
+    nextRateSweepMs_.store(nowMs + std::chrono::duration_cast<std::chrono::milliseconds>(kRateSweepPeriod).count(),
+                           std::memory_order_relaxed);
+    return summaries;
+}
+
+Logger::Summary Logger::makeSummary(const RateState& state, uint64_t suppressed) {
+    return {state.level.load(std::memory_order_relaxed),
+            std::to_string(suppressed) + " message(s) similaire(s) supprimé(s) (" +
+            baseName(state.site->file) + ":" + std::to_string(state.site->line) +
+            (state.context.empty() ? "" : ", " + state.context) + ")"};
+}
+
 void Logger::debug(const std::string& message) {
     log(LogLevel::DEBUG, message);
 }
@@ -43,54 +333,267 @@ void Logger::error(const std::string& message) {
 }
 
 void Logger::log(LogLevel level, const std::string& message) {
-    if (level >= currentLevel_) {
-        writeLog(level, message);
+    if (level < currentLevel_.load(std::memory_order_relaxed)) {
+        return;
     }
+
+    if (async_.load(std::memory_order_acquire)) {
+        if (enqueue(level, message)) return;
+        if (overflowPolicy_ == LogOverflowPolicy::DROP) {
+            dropped_++;
+            return;
+        }
+        // BLOCK: attendre que le thread d'écriture libère une place
+        while (async_.load(std::memory_order_acquire)) {
+            writerCv_.notify_one();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            if (enqueue(level, message)) return;
+        }
+    }
+    writeLog(level, message);
 }
 
 void Logger::writeLog(LogLevel level, const std::string& message) {
+    std::string line(message.size() + 64, '\0');
+    line.resize(formatLine(&line[0], line.size(), level, message));
+
     std::lock_guard<std::mutex> lock(logMutex_);
-    
-    std::string timestamp = getCurrentTimestamp();
-    std::string levelStr = levelToString(level);
-    std::string logLine = "[" + timestamp + "] [" + levelStr + "] " + message;
-    
-    // Log vers la console
+    writeDirect(level, line.data(), line.size());
+}
+
+void Logger::writeDirect(LogLevel level, const char* data, size_t length) {
+    // Appelée avec logMutex_ verrouillé (ou depuis le gestionnaire de crash)
     if (logToConsole_) {
-        if (level >= LogLevel::ERROR) {
-            std::cerr << logLine << std::endl;
+        writeAll(level >= LogLevel::ERROR ? STDERR_FILENO : STDOUT_FILENO, data, length);
+    }
+    if (logFd_ >= 0) {
+        writeAll(logFd_, data, length);
+    }
+}
+
+bool Logger::enqueue(LogLevel level, const std::string& message) {
+    Record* record;
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (true) {
+        record = &ring_[pos & mask_];
+        size_t sequence = record->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false; // File pleine
         } else {
-            std::cout << logLine << std::endl;
+            pos = enqueuePos_.load(std::memory_order_relaxed);
         }
     }
-    
-    // Log vers le fichier
-    if (logFile_ && logFile_->is_open()) {
-        *logFile_ << logLine << std::endl;
-        logFile_->flush();
+
+    // Ligne formatée par le producteur: le thread d'écriture ne fait que copier
+    record->level = level;
+    record->length = static_cast<uint32_t>(formatLine(record->text, kRecordSize, level, message));
+    record->sequence.store(pos + 1, std::memory_order_release);
+
+    if (writerSleeping_.load(std::memory_order_relaxed) || level >= LogLevel::ERROR) {
+        writerCv_.notify_one();
+    }
+    return true;
+}
+
+template <typename Sink>
+bool Logger::dequeue(Sink&& sink) {
+    if (!ring_) return false;
+
+    Record* record;
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    while (true) {
+        record = &ring_[pos & mask_];
+        size_t sequence = record->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false; // Vide, ou ligne en cours d'écriture
+        } else {
+            pos = dequeuePos_.load(std::memory_order_relaxed);
+        }
     }
+
+    sink(*record);
+    record->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
 }
 
-std::string Logger::levelToString(LogLevel level) const {
+void Logger::writerThreadFunction() {
+    std::string fileBatch;
+    std::string outBatch;
+    std::string errBatch;
+    fileBatch.reserve(kMaxBatchRecords * 128);
+    auto nextSweep = std::chrono::steady_clock::now() + kRateSweepPeriod;
+
+    while (true) {
+        size_t count = 0;
+        while (count < kMaxBatchRecords && dequeue([&](const Record& record) {
+            fileBatch.append(record.text, record.length);
+            (record.level >= LogLevel::ERROR ? errBatch : outBatch).append(record.text, record.length);
+        })) {
+            count++;
+        }
+
+        // Résumés des sites revenus au calme, même si plus aucun message n'est émis.
+        // Écrits directement: log() attendrait ce thread avec LogOverflowPolicy::BLOCK
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextSweep) {
+            std::vector<Summary> summaries;
+            {
+                std::lock_guard<std::mutex> lock(rateMutex_);
+                summaries = collectSummaries(steadyMillis(), false);
+            }
+            for (const auto& summary : summaries) {
+                if (summary.level < currentLevel_.load(std::memory_order_relaxed)) continue;
+                char line[kRecordSize];
+                size_t length = formatLine(line, sizeof(line), summary.level, summary.message);
+                fileBatch.append(line, length);
+                (summary.level >= LogLevel::ERROR ? errBatch : outBatch).append(line, length);
+            }
+            nextSweep = now + kRateSweepPeriod;
+        }
+
+        uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != droppedReported_) {
+            std::string message = "Logger: " + std::to_string(dropped - droppedReported_) +
+                                  " message(s) abandonné(s), file pleine";
+            char line[256];
+            size_t length = formatLine(line, sizeof(line), LogLevel::WARN, message);
+            fileBatch.append(line, length);
+            outBatch.append(line, length);
+            droppedReported_ = dropped;
+        }
+
+        if (!fileBatch.empty()) {
+            // Un appel système par destination et par lot
+            {
+                std::lock_guard<std::mutex> lock(logMutex_);
+                if (logToConsole_) {
+                    writeAll(STDOUT_FILENO, outBatch.data(), outBatch.size());
+                    writeAll(STDERR_FILENO, errBatch.data(), errBatch.size());
+                }
+                if (logFd_ >= 0) {
+                    writeAll(logFd_, fileBatch.data(), fileBatch.size());
+                }
+            }
+            fileBatch.clear();
+            outBatch.clear();
+            errBatch.clear();
+            writtenPos_.store(dequeuePos_.load(std::memory_order_relaxed), std::memory_order_release);
+            std::lock_guard<std::mutex> lock(writerMutex_);
+            flushedCv_.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(writerMutex_);
+        bool empty = dequeuePos_.load() == enqueuePos_.load();
+        if (stopWriter_ && empty) break;
+
+        writerSleeping_ = true;
+        writerCv_.wait_for(lock, kWriterIdleTimeout, [this] {
+            return stopWriter_ || dequeuePos_.load() != enqueuePos_.load();
+        });
+        writerSleeping_ = false;
+    }
+}
+
+void Logger::drainForCrash() {
+    // Uniquement des appels async-signal-safe: write(2) sur les descripteurs ouverts
+    while (dequeue([this](const Record& record) { writeDirect(record.level, record.text, record.length); })) {
+    }
+}
+
+void Logger::crashSignalHandler(int signal) {
+    static const char kMessage[] = "Logger: signal fatal, lignes en attente écrites\n";
+    Logger& logger = getInstance();
+    logger.drainForCrash();
+    writeAll(STDERR_FILENO, kMessage, sizeof(kMessage) - 1);
+    raise(signal);
+}
+
+size_t Logger::formatLine(char* out, size_t capacity, LogLevel level, const std::string& message) {
+    // Date formatée une fois par seconde et par thread
+    thread_local std::time_t cachedSecond = -1;
+    thread_local char cachedDate[32];
+
+    auto now = std::chrono::system_clock::now();
+    std::time_t second = std::chrono::system_clock::to_time_t(now);
+    int millis = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count() % 1000);
+    if (second != cachedSecond) {
+        std::tm tm_local;
+        localtime_r(&second, &tm_local);
+        std::strftime(cachedDate, sizeof(cachedDate), "%Y-%m-%d %H:%M:%S", &tm_local);
+        cachedSecond = second;
+    }
+
+    // "[AAAA-MM-JJ HH:MM:SS.mmm] [LEVEL] message\n"
+    char* p = out;
+    *p++ = '[';
+    size_t dateLength = std::strlen(cachedDate);
+    std::memcpy(p, cachedDate, dateLength);
+    p += dateLength;
+    *p++ = '.';
+    *p++ = static_cast<char>('0' + millis / 100);
+    *p++ = static_cast<char>('0' + millis / 10 % 10);
+    *p++ = static_cast<char>('0' + millis % 10);
+    std::memcpy(p, "] [", 3);
+    p += 3;
+    std::memcpy(p, levelToString(level), 5);
+    p += 5;
+    std::memcpy(p, "] ", 2);
+    p += 2;
+
+    size_t room = capacity - static_cast<size_t>(p - out) - 1;
+    if (message.size() <= room) {
+        std::memcpy(p, message.data(), message.size());
+        p += message.size();
+    } else {
+        // Ligne tronquée à la taille d'un enregistrement
+        std::memcpy(p, message.data(), room - 3);
+        p += room - 3;
+        std::memcpy(p, "...", 3);
+        p += 3;
+    }
+    *p++ = '\n';
+    return static_cast<size_t>(p - out);
+}
+
+bool Logger::appendLiteral(std::string& out, const char*& cursor) {
+    while (*cursor) {
+        if (cursor[0] == '{' && cursor[1] == '}') {
+            cursor += 2;
+            return true;
+        }
+        if ((cursor[0] == '{' && cursor[1] == '{') || (cursor[0] == '}' && cursor[1] == '}')) {
+            cursor++; // Accolade échappée
+        }
+        out += *cursor++;
+    }
+    return false;
+}
+
+void Logger::appendFloating(std::string& out, double value) {
+    char buffer[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+#else
+    int length = std::snprintf(buffer, sizeof(buffer), "%g", value);
+    out.append(buffer, static_cast<size_t>(length));
+#endif
+}
+
+const char* Logger::levelToString(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG: return "DEBUG";
         case LogLevel::INFO:  return "INFO ";
         case LogLevel::WARN:  return "WARN ";
         case LogLevel::ERROR: return "ERROR";
-        default: return "UNKNOWN";
+        default: return "?????";
     }
 }
-
-std::string Logger::getCurrentTimestamp() const {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    
-    return ss.str();
-}
-
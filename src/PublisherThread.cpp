@@ -79,6 +79,7 @@ void PublisherThread::removeAcquisitionThread(const std::string& lineId) {
 }
 
 void PublisherThread::threadFunction() {
+    applyThreadTuning(threadTuning_);
     LOG_INFO("Thread de publication en cours d'exécution");
     
     while (!stopRequested_) {
@@ -158,7 +159,7 @@ void PublisherThread::collectAndPublishData() {
         auto token = mqttClient_->publish(pubmsg);
         token->wait();
         
-        LOG_DEBUG("Données publiées sur MQTT: " + std::to_string(jsonData.length()) + " caractères");
+        LOG_DEBUG("Données publiées sur MQTT: {} caractères", jsonData.length());
         
     } catch (const mqtt::exception& e) {
         LOG_ERROR("Erreur lors de la publication MQTT: " + std::string(e.what()));
@@ -188,7 +189,14 @@ std::string PublisherThread::aggregateDataToJson() {
                 threadData.push_back(thread->getData());
             }
             
-            if (!threadData.empty()) {
+            if (threadData.empty()) {
+                continue;
+            }
+            
+            if (config_.publishMode == "timeseries") {
+                // Publier tous les échantillons sous forme de série temporelle compacte
+                productionLines.push_back(timeSeriesToJson(threadData));
+            } else {
                 // Utiliser les données les plus récentes
                 const ModbusData& latestData = threadData.back();
                 
@@ -212,3 +220,37 @@ std::string PublisherThread::aggregateDataToJson() {
     return aggregatedData.dump();
 }
 
+json PublisherThread::timeSeriesToJson(const std::vector<ModbusData>& samples) const {
+    json lineData;
+    lineData["id"] = samples.front().lineId;
+    
+    json timestamps = json::array();
+    json columns = json::object();
+    
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const ModbusData& sample = samples[i];
+        timestamps.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(
+            sample.timestamp.time_since_epoch()).count());
+        
+        for (const auto& pair : sample.values) {
+            json& column = columns[pair.first];
+            // Un point absent des échantillons précédents est complété par null
+            while (column.size() < i) {
+                column.push_back(nullptr);
+            }
+            column.push_back(pair.second);
+        }
+    }
+    
+    // Aligner toutes les colonnes sur le nombre d'échantillons
+    for (auto& column : columns) {
+        while (column.size() < samples.size()) {
+            column.push_back(nullptr);
+        }
+    }
+    
+    lineData["timestamps"] = timestamps;
+    lineData["data"] = columns;
+    
+    return lineData;
+}
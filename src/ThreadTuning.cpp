@@ -0,0 +1,116 @@
+#include "ThreadTuning.h"
+#include "Logger.h"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <cstring>
+#include <cerrno>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Taille de pile pré-chargée par thread lorsque prefaultStack est demandé
+constexpr size_t kPrefaultStackBytes = 256 * 1024;
+
+void prefaultStack() {
+    unsigned char stack[kPrefaultStackBytes];
+    // Écriture via un pointeur volatile pour que le compilateur ne l'élimine pas
+    volatile unsigned char* page = stack;
+    for (size_t i = 0; i < kPrefaultStackBytes; i += 4096) {
+        page[i] = 0;
+    }
+}
+
+bool setThreadName(const std::string& name) {
+    if (name.empty()) {
+        return true;
+    }
+    // Le noyau limite les noms de thread à 15 caractères
+    std::string shortName = name.substr(0, 15);
+#ifdef __APPLE__
+    int rc = pthread_setname_np(shortName.c_str());
+#else
+    int rc = pthread_setname_np(pthread_self(), shortName.c_str());
+#endif
+    if (rc != 0) {
+        LOG_WARN("Impossible de nommer le thread " + name + ": " + std::strerror(rc));
+        return false;
+    }
+    return true;
+}
+
+bool setAffinity(const ThreadTuning& tuning) {
+    if (tuning.cpuAffinity.empty()) {
+        return true;
+    }
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (int cpu : tuning.cpuAffinity) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            LOG_WARN("CPU invalide ignoré pour le thread " + tuning.name + ": " + std::to_string(cpu));
+            continue;
+        }
+        CPU_SET(cpu, &cpuset);
+    }
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+    if (rc != 0) {
+        LOG_WARN("Impossible de fixer l'affinité CPU du thread " + tuning.name + ": " + std::strerror(rc));
+        return false;
+    }
+    return true;
+#else
+    LOG_WARN("Affinité CPU non supportée sur cette plateforme, ignorée pour " + tuning.name);
+    return false;
+#endif
+}
+
+bool setSchedulingPolicy(const ThreadTuning& tuning) {
+    if (tuning.schedPolicy == "other") {
+        return true;
+    }
+    if (tuning.schedPolicy != "fifo") {
+        LOG_WARN("Politique d'ordonnancement inconnue pour " + tuning.name + ": " + tuning.schedPolicy);
+        return false;
+    }
+
+    sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = tuning.schedPriority;
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (rc != 0) {
+        LOG_WARN("Impossible de passer le thread " + tuning.name + " en SCHED_FIFO (priorité " +
+                 std::to_string(tuning.schedPriority) + "): " + std::strerror(rc));
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool applyThreadTuning(const ThreadTuning& tuning) {
+    bool ok = setThreadName(tuning.name);
+    ok = setAffinity(tuning) && ok;
+    ok = setSchedulingPolicy(tuning) && ok;
+
+    if (tuning.prefaultStack) {
+        prefaultStack();
+    }
+    return ok;
+}
+
+bool lockProcessMemory() {
+#ifdef __GLIBC__
+    // Ne jamais rendre le tas au système, ni servir les grosses allocations par mmap
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+#endif
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        LOG_WARN("Impossible de verrouiller la mémoire du processus: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    LOG_INFO("Mémoire du processus verrouillée");
+    return true;
+}
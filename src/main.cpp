@@ -4,6 +4,8 @@
 #include <vector>
 #include <thread>
 #include <map>
+#include <mutex>
+#include <atomic>
 #include <algorithm>
 #include <chrono>
 #include <nlohmann/json.hpp>
@@ -11,29 +13,73 @@
 #include "Logger.h"
 #include "ConfigManager.h"
 #include "ConfigThread.h"
+#include "ConfigDiff.h"
+#include "ConfigWatcher.h"
 
 // --- Utilisation de la nouvelle bibliothèque modbustt ---
 #include "modbus_collector.h"
 #include "exporters/mqtt_exporter.h" // On supposera que cet exporter existe
 #include "exporters/file_exporter.h"
+#include "exporters/tcp_exporter.h"
+#include "exporters/timeseries_store_exporter.h"
+#include "exporters/influx_line_exporter.h"
+#include "exporters/syslog_exporter.h"
+#include "exporters/modbus_server_exporter.h"
+#include "exporters/prometheus_exporter.h"
+#include "exporters/shared_memory_exporter.h"
+#ifdef MODBUSTT_HAVE_ZMQ
+#include "exporters/zmq_exporter.h"
+#endif
 
 using json = nlohmann::json;
 
 // Variables globales pour la gestion des signaux
-static bool g_running = true;
+static std::atomic<bool> g_running{true};
+static volatile sig_atomic_t g_receivedSignal = 0;
 static std::unique_ptr<ConfigThread> g_configThread;
+static ConfigWatcher g_configWatcher;
 static std::map<std::string, std::shared_ptr<modbustt::ModbusCollector>> g_collectors;
+// Commandes MQTT (thread de configuration) et rechargement (thread principal) modifient g_collectors
+static std::mutex g_collectorsMutex;
+// Exporters partagés par tous les collecteurs, créés une seule fois
+static std::vector<std::shared_ptr<modbustt::exporters::IExporter>> g_exporters;
+static std::shared_ptr<modbustt::exporters::PrometheusExporter> g_metricsExporter;
 
-// Gestionnaire de signaux pour arrêt propre
+// Gestionnaire de signaux pour arrêt propre: uniquement des opérations
+// async-signal-safe, le message est écrit par la boucle principale
 void signalHandler(int signal) {
-    LOG_INFO("Signal reçu (" + std::to_string(signal) + "), arrêt en cours...");
+    g_receivedSignal = signal;
     g_running = false;
+    g_configWatcher.wakeup(); // Débloque la boucle principale
 }
 
-void createCollectors(const std::vector<ProductionLineConfig>& lines, ConfigManager& configManager);
+void createCollectors(const std::vector<ProductionLineConfig>& lines);
+void stopCollector(const std::string& lineId);
+
+// Applique la section "logging" de la configuration au logger
+void applyLoggingConfig(const LoggingConfig& config) {
+    Logger& logger = Logger::getInstance();
+    if (config.level == "DEBUG") logger.setLogLevel(LogLevel::DEBUG);
+    else if (config.level == "WARN") logger.setLogLevel(LogLevel::WARN);
+    else if (config.level == "ERROR") logger.setLogLevel(LogLevel::ERROR);
+    else logger.setLogLevel(LogLevel::INFO);
+    
+    if (config.file != "supervision.log") {
+        logger.setLogFile(config.file);
+    }
+    logger.setConsoleOutput(config.console);
+    logger.setRateLimit(static_cast<uint32_t>(std::max(config.rateLimitBurst, 0)),
+                        std::chrono::seconds(std::max(config.rateLimitIntervalS, 1)));
+    
+    if (config.async) {
+        logger.enableAsync(static_cast<size_t>(std::max(config.queueSize, 2)),
+                           config.overflow == "block" ? LogOverflowPolicy::BLOCK : LogOverflowPolicy::DROP);
+    }
+}
 
 // Fonction pour traiter les commandes de reconfiguration
 void handleReconfigurationCommand(const std::string& command, const std::string& parameters, ConfigManager& configManager) {
+    std::lock_guard<std::mutex> lock(g_collectorsMutex);
     try {
         json cmd = json::parse(parameters);
         std::string commandType = cmd["command"];
@@ -74,12 +120,10 @@ void handleReconfigurationCommand(const std::string& command, const std::string&
         else if (commandType == "stop_line") {
             if (cmd.contains("line_ids")) {
                 for (const auto& lineId : cmd["line_ids"]) {
-                    auto it = g_collectors.find(lineId.get<std::string>());
-                    if (it != g_collectors.end()) {
-                        it->second->stop();
-                        it->second->join();
-                        g_collectors.erase(it);
-                        LOG_INFO("Ligne arrêtée: " + it->first);
+                    std::string id = lineId.get<std::string>();
+                    if (g_collectors.count(id)) {
+                        stopCollector(id);
+                        LOG_INFO("Ligne arrêtée: " + id);
                     }
                 }
             }
@@ -90,23 +134,21 @@ void handleReconfigurationCommand(const std::string& command, const std::string&
                     std::string lineId = lineIdJson.get<std::string>();
 
                     // 1. Vérifier si la ligne existe et l'arrêter si c'est le cas
-                    auto it = g_collectors.find(lineId);
-                    if (it != g_collectors.end()) {
+                    if (g_collectors.count(lineId)) {
                         LOG_INFO("Redémarrage: arrêt de la ligne existante " + lineId);
-                        it->second->stop();
-                        it->second->join();
-                        g_collectors.erase(it);
+                        stopCollector(lineId);
                     }
 
                     // 2. Recréer la ligne à partir de la configuration initiale
                     // Note: une version plus avancée utiliserait la config fournie dans la commande
-                    const auto& allLines = configManager.getProductionLines();
+                    auto config = configManager.getSnapshot();
+                    const auto& allLines = config->productionLines;
                     auto lineConfigIt = std::find_if(allLines.begin(), allLines.end(), 
                                                      [&lineId](const ProductionLineConfig& cfg){ return cfg.id == lineId; });
 
                     if (lineConfigIt != allLines.end()) {
                         LOG_INFO("Redémarrage: création d'un nouveau thread pour " + lineId);
-                        createCollectors({*lineConfigIt}, configManager);
+                        createCollectors({*lineConfigIt});
                     } else {
                         LOG_WARN("Impossible de redémarrer la ligne " + lineId + ": configuration initiale non trouvée.");
                     }
@@ -122,65 +164,260 @@ void handleReconfigurationCommand(const std::string& command, const std::string&
     }
 }
 
-// Fonction pour créer et démarrer les threads d'acquisition
-void createCollectors(const std::vector<ProductionLineConfig>& lines, ConfigManager& configManager) {
-    // Créer les exporters une seule fois (ils peuvent être partagés)
-    // Pour cet exemple, on crée un exporter MQTT et un exporter Fichier
+// Fonction pour créer les exporters partagés par tous les collecteurs
+void createExporters(const ConfigSnapshot& config) {
     auto mqttExporter = std::make_shared<modbustt::exporters::MqttExporter>();
     json mqttConfigJson;
-    const auto& mqttConfig = configManager.getMqttConfig();
+    const auto& mqttConfig = config.mqtt;
     mqttConfigJson["broker_address"] = mqttConfig.broker;
     mqttConfigJson["port"] = mqttConfig.port;
     mqttConfigJson["client_id"] = mqttConfig.clientId + "_modbustt";
     mqttConfigJson["topic"] = mqttConfig.publishTopic;
+    mqttConfigJson["qos"] = mqttConfig.qos;
+    mqttConfigJson["linger_ms"] = mqttConfig.lingerMs;
+    mqttConfigJson["max_batch_bytes"] = mqttConfig.maxBatchBytes;
+    mqttConfigJson["max_in_flight"] = mqttConfig.maxInFlight;
+    mqttConfigJson.update(config.getExporterConfig("mqtt"));
     mqttExporter->configure(mqttConfigJson);
     mqttExporter->connect();
 
     auto fileExporter = std::make_shared<modbustt::exporters::FileExporter>();
-    fileExporter->configure({{"filepath", "telemetry_data.json"}});
+    json fileConfigJson = {{"filepath", "telemetry_data.json"}};
+    fileConfigJson.update(config.getExporterConfig("file"));
+    fileExporter->configure(fileConfigJson);
     fileExporter->connect();
 
+    g_exporters = {
+        mqttExporter, // Publie sur MQTT
+        fileExporter  // Et écrit dans un fichier
+    };
+
+    // Exporters optionnels, activés par "enabled: true" dans la section exporters
+    json tcpConfigJson = config.getExporterConfig("tcp");
+    if (tcpConfigJson.value("enabled", false)) {
+        auto tcpExporter = std::make_shared<modbustt::exporters::TcpExporter>();
+        tcpExporter->configure(tcpConfigJson);
+        tcpExporter->connect();
+        g_exporters.push_back(tcpExporter);
+    }
+
+    json tsdbConfigJson = config.getExporterConfig("timeseries");
+    if (tsdbConfigJson.value("enabled", false)) {
+        auto tsdbExporter = std::make_shared<modbustt::exporters::TimeSeriesStoreExporter>();
+        tsdbExporter->configure(tsdbConfigJson);
+        tsdbExporter->connect();
+        g_exporters.push_back(tsdbExporter);
+    }
+
+    json influxConfigJson = config.getExporterConfig("influx");
+    if (influxConfigJson.value("enabled", false)) {
+        auto influxExporter = std::make_shared<modbustt::exporters::InfluxLineExporter>();
+        influxExporter->configure(influxConfigJson);
+        influxExporter->connect();
+        g_exporters.push_back(influxExporter);
+    }
+
+    json syslogConfigJson = config.getExporterConfig("syslog");
+    if (syslogConfigJson.value("enabled", false)) {
+        auto syslogExporter = std::make_shared<modbustt::exporters::SyslogExporter>();
+        syslogExporter->configure(syslogConfigJson);
+        syslogExporter->connect();
+        g_exporters.push_back(syslogExporter);
+    }
+
+    json modbusServerConfigJson = config.getExporterConfig("modbus_server");
+    if (modbusServerConfigJson.value("enabled", false)) {
+        auto modbusServerExporter = std::make_shared<modbustt::exporters::ModbusServerExporter>();
+        modbusServerExporter->configure(modbusServerConfigJson);
+        modbusServerExporter->connect();
+        g_exporters.push_back(modbusServerExporter);
+    }
+
+    json shmConfigJson = config.getExporterConfig("shared_memory");
+    if (shmConfigJson.value("enabled", false)) {
+        auto shmExporter = std::make_shared<modbustt::exporters::SharedMemoryExporter>();
+        shmExporter->configure(shmConfigJson);
+        shmExporter->connect();
+        g_exporters.push_back(shmExporter);
+    }
+
+    json metricsConfigJson = config.getExporterConfig("prometheus");
+    if (metricsConfigJson.value("enabled", false)) {
+        g_metricsExporter = std::make_shared<modbustt::exporters::PrometheusExporter>();
+        g_metricsExporter->configure(metricsConfigJson);
+        g_metricsExporter->connect();
+        g_exporters.push_back(g_metricsExporter);
+    }
+
+    json zmqConfigJson = config.getExporterConfig("zmq");
+    if (zmqConfigJson.value("enabled", false)) {
+#ifdef MODBUSTT_HAVE_ZMQ
+        auto zmqExporter = std::make_shared<modbustt::exporters::ZmqExporter>();
+        zmqExporter->configure(zmqConfigJson);
+        zmqExporter->connect();
+        g_exporters.push_back(zmqExporter);
+#else
+        LOG_WARN("Exporter ZeroMQ activé mais modbustt compilé sans libzmq");
+#endif
+    }
+}
+
+// Traduit une table de registres de l'app en table de la lib. Une table de
+// profil n'est traduite qu'une fois: tous ses collecteurs partagent le résultat
+// (g_collectorsMutex tenu par l'appelant).
+std::shared_ptr<const modbustt::RegisterTable> toRegisterTable(const std::shared_ptr<const RegisterTable>& registers) {
+    static std::map<std::shared_ptr<const RegisterTable>, std::shared_ptr<const modbustt::RegisterTable>> translated;
+    
+    auto it = translated.find(registers);
+    if (it != translated.end()) {
+        return it->second;
+    }
+    
+    // Oublier les tables qui ne sont plus référencées que par ce cache (configurations précédentes)
+    for (auto entry = translated.begin(); entry != translated.end();) {
+        entry = entry->first.use_count() == 1 ? translated.erase(entry) : std::next(entry);
+    }
+    
+    auto result = std::make_shared<modbustt::RegisterTable>();
+    result->reserve(registers->size());
+    for (const auto& reg : *registers) {
+        modbustt::RegisterConfig registerConfig;
+        registerConfig.address = reg.address;
+        registerConfig.name = reg.name;
+        registerConfig.type = reg.type;
+        registerConfig.scale = reg.scale;
+        registerConfig.offset = reg.offset;
+        result->push_back(std::move(registerConfig));
+    }
+    translated.emplace(registers, result);
+    return result;
+}
+
+// Crée et démarre le collecteur d'une ligne (g_collectorsMutex tenu par l'appelant)
+void startCollector(const ProductionLineConfig& line) {
+    ScopedLogContext logContext(line.id);
+    
+    // Traduire la config de l'app en config pour la lib
+    modbustt::CollectorConfig collectorConfig;
+    collectorConfig.id = line.id;
+    collectorConfig.protocol = "tcp"; // Supposons TCP pour l'instant
+    collectorConfig.ip_address = line.ip;
+    collectorConfig.port = line.port;
+    collectorConfig.unit_id = line.unitId;
+    collectorConfig.acquisition_frequency_ms = line.acquisitionFrequencyMs;
+    collectorConfig.register_table = toRegisterTable(line.registers);
+    collectorConfig.cpu_affinity = line.threadTuning.cpuAffinity;
+    collectorConfig.sched_policy = line.threadTuning.schedPolicy;
+    collectorConfig.sched_priority = line.threadTuning.schedPriority;
+    collectorConfig.prefault_stack = line.threadTuning.prefaultStack;
+
+    auto collector = std::make_shared<modbustt::ModbusCollector>(collectorConfig); 
+    for (const auto& exporter : g_exporters) {
+        collector->addExporter(exporter);
+    }
+    if (g_metricsExporter) {
+        // weak_ptr: un collecteur arrêté disparaît des métriques
+        std::weak_ptr<modbustt::ModbusCollector> weakCollector = collector;
+        g_metricsExporter->add_stats_source(line.id, [weakCollector](modbustt::CollectorStats& stats) {
+            auto c = weakCollector.lock();
+            if (!c) return false;
+            stats = c->getStats();
+            return true;
+        });
+    }
+    if (collector->start()) {
+        g_collectors[line.id] = collector;
+        LOG_INFO("Collecteur démarré pour: " + line.id);
+    } else {
+        LOG_ERROR("Impossible de démarrer le collecteur pour: " + line.id);
+    }
+}
+
+// Arrête et retire le collecteur d'une ligne (g_collectorsMutex tenu par l'appelant)
+void stopCollector(const std::string& lineId) {
+    auto it = g_collectors.find(lineId);
+    if (it == g_collectors.end()) {
+        return;
+    }
+    it->second->stop();
+    it->second->join();
+    g_collectors.erase(it);
+}
+
+// Fonction pour créer et démarrer les threads d'acquisition
+void createCollectors(const std::vector<ProductionLineConfig>& lines) {
     for (const auto& line : lines) {
         if (line.enabled) {
-            // Traduire la config de l'app en config pour la lib
-            modbustt::CollectorConfig collectorConfig;
-            collectorConfig.id = line.id;
-            collectorConfig.protocol = "tcp"; // Supposons TCP pour l'instant
-            collectorConfig.ip_address = line.ip;
-            collectorConfig.port = line.port;
-            collectorConfig.unit_id = line.unitId;
-            collectorConfig.acquisition_frequency_ms = line.acquisitionFrequencyMs;
-            // ... mapper les registres ...
-
-            auto collector = std::make_shared<modbustt::ModbusCollector>(collectorConfig); 
-            collector->addExporter(mqttExporter); // Publie sur MQTT
-            collector->addExporter(fileExporter); // Et écrit dans un fichier
-            if (collector->start()) {
-                g_collectors[line.id] = collector;
-                LOG_INFO("Collecteur démarré pour: " + line.id);
-            } else {
-                LOG_ERROR("Impossible de démarrer le collecteur pour: " + line.id);
-            }
+            startCollector(line);
         } else {
+            ScopedLogContext logContext(line.id);
             LOG_INFO("Ligne désactivée, thread non créé: " + line.id);
         }
     }
 }
 
+// Applique une nouvelle configuration des lignes: seuls les collecteurs modifiés sont touchés
+void applyLineChanges(const std::vector<LineDiff>& diffs) {
+    std::lock_guard<std::mutex> lock(g_collectorsMutex);
+    for (const auto& diff : diffs) {
+        ScopedLogContext logContext(diff.id);
+        if (diff.removed) {
+            LOG_INFO("Rechargement: arrêt de la ligne retirée " + diff.id);
+            stopCollector(diff.id);
+        } else if (diff.added) {
+            LOG_INFO("Rechargement: démarrage de la nouvelle ligne " + diff.id);
+            startCollector(diff.line);
+        } else {
+            // Ligne arrêtée par une commande stop_line: laissée arrêtée, même si sa connexion change
+            auto it = g_collectors.find(diff.id);
+            if (it == g_collectors.end()) continue;
+            if (diff.requiresRestart()) {
+                LOG_INFO("Rechargement: redémarrage de la ligne " + diff.id + " (connexion ou thread modifiés)");
+                stopCollector(diff.id);
+                startCollector(diff.line);
+                continue;
+            }
+            if (diff.registersChanged) {
+                it->second->setRegisters(toRegisterTable(diff.line.registers));
+                LOG_INFO("Rechargement: registres mis à jour pour " + diff.id);
+            }
+            if (diff.rateChanged) {
+                it->second->setFrequency(diff.line.acquisitionFrequencyMs);
+                LOG_INFO("Rechargement: cadence de {} passée à {}ms", diff.id, diff.line.acquisitionFrequencyMs);
+            }
+        }
+    }
+    LOG_INFO("Rechargement: " + std::to_string(diffs.size()) + " ligne(s) modifiée(s), " +
+             std::to_string(g_collectors.size()) + " collecteur(s) actif(s)");
+}
+
 // Fonction pour arrêter tous les threads
 void stopAllThreads() {
     LOG_INFO("Arrêt de tous les threads...");
     
-    // Arrêter les threads d'acquisition
-    for (auto& pair : g_collectors) {
-        pair.second->stop();
-    }
-    
-    // Attendre la fin des threads d'acquisition
-    for (auto& pair : g_collectors) {
-        pair.second->join();
+    {
+        // Relâché avant l'arrêt du thread de configuration, qui peut attendre ce verrou
+        std::lock_guard<std::mutex> lock(g_collectorsMutex);
+        
+        // Arrêter les threads d'acquisition
+        for (auto& pair : g_collectors) {
+            pair.second->stop();
+        }
+        
+        // Attendre la fin des threads d'acquisition
+        for (auto& pair : g_collectors) {
+            pair.second->join();
+        }
+        g_collectors.clear();
+        
+        // Vider et arrêter les exporters tant que le logger est actif: détruits
+        // avec les variables globales, ils journaliseraient après sa destruction
+        for (auto& exporter : g_exporters) {
+            exporter->disconnect();
+        }
+        g_exporters.clear();
+        g_metricsExporter.reset();
     }
-    g_collectors.clear();
     
     // Arrêter le thread de configuration
     if (g_configThread) {
@@ -199,6 +436,7 @@ int main(int argc, char* argv[]) {
     // Initialisation du logger
     Logger::getInstance().setLogLevel(LogLevel::INFO);
     Logger::getInstance().setLogFile("supervision.log");
+    Logger::getInstance().installCrashHandlers();
     
     LOG_INFO("=== Démarrage du Système de Supervision ===");
     
@@ -215,14 +453,25 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    const auto& mqttConfig = configManager.getMqttConfig();
-    const auto& productionLines = configManager.getProductionLines();
+    // Instantané de démarrage: les références ci-dessous restent valides après un rechargement
+    auto config = configManager.getSnapshot();
+    applyLoggingConfig(config->logging);
+    
+    const auto& mqttConfig = config->mqtt;
+    const auto& productionLines = config->productionLines;
+    const auto& threadingConfig = config->threading;
+    
+    // Verrouillage mémoire avant la création des threads
+    if (threadingConfig.lockMemory) {
+        lockProcessMemory();
+    }
     
     LOG_INFO("Configuration chargée: " + std::to_string(productionLines.size()) + " lignes de production");
     
     try {
         // Créer et démarrer le thread de configuration
         g_configThread = std::make_unique<ConfigThread>(mqttConfig);
+        g_configThread->setThreadTuning(threadingConfig.config);
         // On passe configManager à la callback pour pouvoir recréer les lignes
         g_configThread->setReconfigurationCallback([&configManager](const std::string& cmd, const std::string& params) {
             handleReconfigurationCommand(cmd, params, configManager);
@@ -232,39 +481,44 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
-        // Créer et démarrer les collecteurs
-        createCollectors(productionLines, configManager);
+        // Créer les exporters puis démarrer les collecteurs
+        createExporters(*config);
+        {
+            std::lock_guard<std::mutex> lock(g_collectorsMutex);
+            createCollectors(productionLines);
+        }
         
         LOG_INFO("Système de supervision démarré avec succès");
         
-        // Boucle principale - surveillance des changements de configuration
-        auto lastConfigCheck = std::chrono::steady_clock::now();
-        const auto configCheckInterval = std::chrono::seconds(10);
+        // Boucle principale - bloquée jusqu'à une modification de la configuration ou un signal
+        g_configWatcher.start(configFile);
         
         while (g_running) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            if (!g_configWatcher.waitForChange()) {
+                continue;
+            }
             
-            // Vérifier périodiquement les changements de configuration
-            auto now = std::chrono::steady_clock::now();
-            if (now - lastConfigCheck >= configCheckInterval) {
-                if (configManager.hasConfigChanged()) {
-                    LOG_INFO("Changement de configuration détecté, rechargement...");
-                    if (configManager.reloadConfig()) {
-                        configManager.markConfigAsRead();
-                        // Note: Pour une implémentation complète, il faudrait ici
-                        // reconfigurer les threads existants ou en créer de nouveaux
-                        LOG_INFO("Configuration rechargée avec succès");
-                    } else {
-                        LOG_ERROR("Erreur lors du rechargement de la configuration");
-                    }
-                }
-                lastConfigCheck = now;
+            LOG_INFO("Changement de configuration détecté, rechargement...");
+            auto previous = configManager.getSnapshot();
+            if (configManager.reloadConfig()) {
+                configManager.markConfigAsRead();
+                // Les exporters et la section mqtt ne sont pas rechargés à chaud
+                applyLineChanges(diffProductionLines(previous->productionLines,
+                                                     configManager.getSnapshot()->productionLines));
+                LOG_INFO("Configuration rechargée avec succès");
+            } else {
+                LOG_ERROR("Erreur lors du rechargement de la configuration");
             }
         }
         
+        if (g_receivedSignal != 0) {
+            LOG_INFO("Signal reçu ({}), arrêt en cours...", static_cast<int>(g_receivedSignal));
+        }
+        
     } catch (const std::exception& e) {
         LOG_ERROR("Erreur fatale: " + std::string(e.what()));
         stopAllThreads();
+        Logger::getInstance().shutdown();
         return 1;
     }
     
@@ -272,5 +526,6 @@ int main(int argc, char* argv[]) {
     stopAllThreads();
     
     LOG_INFO("=== Arrêt du Système de Supervision ===");
+    Logger::getInstance().shutdown();
     return 0;
 }
@@ -0,0 +1,139 @@
+#include "ConfigDiff.h"
+#include "test_helpers.h"
+
+namespace {
+
+std::shared_ptr<const RegisterTable> makeTable(double scale = 1.0) {
+    return std::make_shared<const RegisterTable>(RegisterTable{
+        {1, "temperature", "holding", scale, 0.0},
+        {2, "pression", "input", 0.1, 0.0},
+    });
+}
+
+ProductionLineConfig makeLine(const std::string& id, std::shared_ptr<const RegisterTable> registers = makeTable()) {
+    ProductionLineConfig line;
+    line.id = id;
+    line.ip = "192.168.1.10";
+    line.registers = std::move(registers);
+    return line;
+}
+
+const LineDiff* findDiff(const std::vector<LineDiff>& diffs, const std::string& id) {
+    for (const auto& diff : diffs) {
+        if (diff.id == id) return &diff;
+    }
+    return nullptr;
+}
+
+void testUnchangedLinesOmitted() {
+    std::vector<ProductionLineConfig> previous = {makeLine("L1"), makeLine("L2")};
+    // Tables distinctes mais identiques: pas de changement
+    std::vector<ProductionLineConfig> current = {makeLine("L2"), makeLine("L1")};
+    CHECK(diffProductionLines(previous, current).empty());
+    CHECK(diffProductionLines({}, {}).empty());
+}
+
+// Lignes retirées d'abord, puis les autres dans l'ordre de la nouvelle configuration
+void testAddedAndRemoved() {
+    std::vector<ProductionLineConfig> previous = {makeLine("L1"), makeLine("L2")};
+    std::vector<ProductionLineConfig> current = {makeLine("L3"), makeLine("L1")};
+    current[1].acquisitionFrequencyMs = 500;
+
+    auto diffs = diffProductionLines(previous, current);
+    CHECK_EQ(diffs.size(), 3u);
+    if (diffs.size() != 3) return;
+    CHECK_EQ(diffs[0].id, std::string("L2"));
+    CHECK(diffs[0].removed);
+    CHECK_EQ(diffs[0].line.ip, std::string("192.168.1.10"));
+    CHECK_EQ(diffs[1].id, std::string("L3"));
+    CHECK(diffs[1].added);
+    CHECK_EQ(diffs[2].id, std::string("L1"));
+    CHECK(!diffs[2].added && !diffs[2].removed);
+}
+
+// Une ligne désactivée est absente: l'activer l'ajoute, la désactiver la retire
+void testEnabledToggle() {
+    ProductionLineConfig disabled = makeLine("L1");
+    disabled.enabled = false;
+
+    auto enabling = diffProductionLines({disabled}, {makeLine("L1")});
+    CHECK_EQ(enabling.size(), 1u);
+    CHECK(!enabling.empty() && enabling[0].added);
+
+    auto disabling = diffProductionLines({makeLine("L1")}, {disabled});
+    CHECK_EQ(disabling.size(), 1u);
+    CHECK(!disabling.empty() && disabling[0].removed);
+
+    CHECK(diffProductionLines({disabled}, {disabled}).empty());
+}
+
+// Cadence et registres s'appliquent à chaud, connexion et thread imposent un redémarrage
+void testClassification() {
+    ProductionLineConfig base = makeLine("L1");
+
+    ProductionLineConfig rate = base;
+    rate.acquisitionFrequencyMs = 1000;
+    auto diffs = diffProductionLines({base}, {rate});
+    CHECK(!diffs.empty() && diffs[0].rateChanged && !diffs[0].registersChanged && !diffs[0].requiresRestart());
+
+    ProductionLineConfig registers = base;
+    registers.registers = makeTable(0.5);
+    diffs = diffProductionLines({base}, {registers});
+    CHECK(!diffs.empty() && diffs[0].registersChanged && !diffs[0].rateChanged && !diffs[0].requiresRestart());
+
+    ProductionLineConfig reordered = base;
+    reordered.registers = std::make_shared<const RegisterTable>(
+        RegisterTable{(*base.registers)[1], (*base.registers)[0]});
+    diffs = diffProductionLines({base}, {reordered});
+    CHECK(!diffs.empty() && diffs[0].registersChanged);
+
+    ProductionLineConfig port = base;
+    port.port = 5020;
+    diffs = diffProductionLines({base}, {port});
+    CHECK(!diffs.empty() && diffs[0].endpointChanged && diffs[0].requiresRestart());
+
+    ProductionLineConfig unit = base;
+    unit.unitId = 7;
+    diffs = diffProductionLines({base}, {unit});
+    CHECK(!diffs.empty() && diffs[0].endpointChanged && diffs[0].requiresRestart());
+
+    ProductionLineConfig address = base;
+    address.ip = "192.168.1.11";
+    diffs = diffProductionLines({base}, {address});
+    CHECK(!diffs.empty() && diffs[0].endpointChanged && !diffs[0].tuningChanged);
+
+    ProductionLineConfig tuning = base;
+    tuning.threadTuning.cpuAffinity = {2};
+    diffs = diffProductionLines({base}, {tuning});
+    CHECK(!diffs.empty() && diffs[0].tuningChanged && diffs[0].requiresRestart() && !diffs[0].endpointChanged);
+
+    // Champs sans effet sur le collecteur: aucune différence
+    ProductionLineConfig queue = base;
+    queue.queueCapacity = 500;
+    CHECK(diffProductionLines({base}, {queue}).empty());
+}
+
+// Lignes d'un même profil: table partagée, comparée une fois par paire
+void testSharedProfileTables() {
+    auto before = makeTable();
+    auto after = makeTable(2.0);
+    std::vector<ProductionLineConfig> previous = {makeLine("P1", before), makeLine("P2", before), makeLine("X", before)};
+    std::vector<ProductionLineConfig> current = {makeLine("P1", after), makeLine("P2", after), makeLine("X", before)};
+
+    auto diffs = diffProductionLines(previous, current);
+    CHECK_EQ(diffs.size(), 2u);
+    CHECK(findDiff(diffs, "P1") && findDiff(diffs, "P1")->registersChanged);
+    CHECK(findDiff(diffs, "P2") && findDiff(diffs, "P2")->registersChanged);
+    CHECK(findDiff(diffs, "X") == nullptr);
+}
+
+} // namespace
+
+int main() {
+    testUnchangedLinesOmitted();
+    testAddedAndRemoved();
+    testEnabledToggle();
+    testClassification();
+    testSharedProfileTables();
+    return TEST_RESULT();
+}
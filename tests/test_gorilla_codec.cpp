@@ -0,0 +1,139 @@
+#include "exporters/gorilla_codec.h"
+#include "test_helpers.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <utility>
+
+using namespace modbustt::exporters;
+
+namespace {
+
+using Series = std::vector<std::pair<int64_t, double>>;
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// Encode puis relit la série: horodatages et valeurs identiques au bit près
+void checkRoundTrip(const Series& series) {
+    GorillaEncoder encoder;
+    for (const auto& point : series) {
+        encoder.append(point.first, point.second);
+    }
+    CHECK_EQ(encoder.count(), series.size());
+    if (!series.empty()) {
+        CHECK_EQ(encoder.first_timestamp(), series.front().first);
+        CHECK_EQ(encoder.last_timestamp(), series.back().first);
+    }
+
+    GorillaDecoder decoder(encoder.bytes().data(), encoder.bytes().size(), encoder.count());
+    int64_t timestamp;
+    double value;
+    size_t index = 0;
+    while (decoder.next(timestamp, value)) {
+        CHECK(index < series.size());
+        if (index >= series.size()) return;
+        CHECK_EQ(timestamp, series[index].first);
+        CHECK(sameBits(value, series[index].second));
+        index++;
+    }
+    CHECK_EQ(index, series.size());
+}
+
+// Cadence fixe et valeur lente: le cas pour lequel le codage est conçu
+void testRegularSeries() {
+    Series series;
+    for (int i = 0; i < 1000; ++i) {
+        series.emplace_back(1700000000000 + i * 1000, 20.0 + (i / 100) * 0.5);
+    }
+    checkRoundTrip(series);
+
+    GorillaEncoder encoder;
+    for (const auto& point : series) {
+        encoder.append(point.first, point.second);
+    }
+    // Delta-of-delta nul et valeur répétée: environ 2 bits par point
+    CHECK(encoder.bytes().size() < series.size() / 2);
+}
+
+// Gigue, trous, horodatages répétés ou en arrière, tous les ordres de grandeur d'écart
+void testIrregularTimestamps() {
+    const int64_t deltas[] = {1000, 1000, 1003, 997, 0, 0, -5, 64, -63, 256, -255, 2048, -2047,
+                              100000, -100000, int64_t(1) << 31, -(int64_t(1) << 31), 7};
+    Series series;
+    int64_t timestamp = 1700000000000;
+    for (int64_t delta : deltas) {
+        timestamp += delta;
+        series.emplace_back(timestamp, 1.0);
+    }
+    checkRoundTrip(series);
+}
+
+// Valeurs spéciales: zéros signés, NaN, infinis, sous-normaux, extrêmes
+void testSpecialValues() {
+    const double values[] = {0.0, -0.0, 1.0, 1.0, -1.0, std::numeric_limits<double>::quiet_NaN(),
+                             std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                             std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::max(),
+                             std::numeric_limits<double>::lowest(), 1e-300, 0.1, 0.1};
+    Series series;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        series.emplace_back(static_cast<int64_t>(i) * 1000, values[i]);
+    }
+    checkRoundTrip(series);
+}
+
+// Motifs aléatoires: tous les nombres de bits significatifs du XOR
+void testRandomSeries() {
+    std::mt19937_64 rng(7);
+    for (int run = 0; run < 50; ++run) {
+        Series series;
+        int64_t timestamp = static_cast<int64_t>(rng() % 2000000000000);
+        for (int i = 0; i < 500; ++i) {
+            timestamp += static_cast<int64_t>(rng() % 5000) - 1000;
+            uint64_t bits = rng();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            series.emplace_back(timestamp, (run % 2) ? value : static_cast<double>(rng() % 1000) / 8.0);
+        }
+        checkRoundTrip(series);
+    }
+}
+
+void testSinglePoint() {
+    checkRoundTrip({{-1, 42.0}});
+    checkRoundTrip({});
+}
+
+// Données tronquées (bloc partiellement écrit): le décodeur s'arrête sans déborder
+void testTruncatedInput() {
+    GorillaEncoder encoder;
+    for (int i = 0; i < 100; ++i) {
+        encoder.append(i * 1000 + (i % 3), i * 1.5);
+    }
+    const std::string& bytes = encoder.bytes();
+    for (size_t size = 0; size < bytes.size(); size += 7) {
+        GorillaDecoder decoder(bytes.data(), size, encoder.count());
+        int64_t timestamp;
+        double value;
+        size_t read = 0;
+        while (decoder.next(timestamp, value)) {
+            CHECK_EQ(timestamp, static_cast<int64_t>(read) * 1000 + static_cast<int64_t>(read % 3));
+            read++;
+        }
+        CHECK(read < encoder.count());
+    }
+}
+
+} // namespace
+
+int main() {
+    testRegularSeries();
+    testIrregularTimestamps();
+    testSpecialValues();
+    testRandomSeries();
+    testSinglePoint();
+    testTruncatedInput();
+    return TEST_RESULT();
+}
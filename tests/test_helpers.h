@@ -0,0 +1,35 @@
+#pragma once
+
+#include <iostream>
+
+/**
+ * Vérifications minimales des tests unitaires: un échec est affiché et compté,
+ * le test continue. main() retourne TEST_RESULT() (0 si tout a réussi).
+ */
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": échec: " #condition << std::endl; \
+            testFailures()++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        const auto& actual_ = (actual); \
+        const auto& expected_ = (expected); \
+        if (!(actual_ == expected_)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": échec: " #actual " == " #expected \
+                      << "\n  obtenu:  " << actual_ << "\n  attendu: " << expected_ << std::endl; \
+            testFailures()++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() \
+    (testFailures() == 0 ? (std::cout << "OK" << std::endl, 0) \
+                         : (std::cerr << testFailures() << " échec(s)" << std::endl, 1))
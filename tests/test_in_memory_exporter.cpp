@@ -0,0 +1,213 @@
+#include "exporters/in_memory_exporter.h"
+#include "test_helpers.h"
+#include <atomic>
+#include <thread>
+
+using namespace modbustt;
+using namespace modbustt::exporters;
+
+namespace {
+
+std::chrono::system_clock::time_point at(int64_t seconds) {
+    return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+}
+
+// Trame n: tous ses points valent n, horodatée à la seconde n
+TelemetryData frame(const std::string& id, int n, size_t points = 2) {
+    TelemetryData data(id, {});
+    data.timestamp = at(n);
+    for (size_t i = 0; i < points; ++i) {
+        data.values["p" + std::to_string(i)] = n;
+    }
+    return data;
+}
+
+// Anneau de 4 cases après 10 trames: seules les 4 dernières restent
+void testWraparound() {
+    InMemoryExporter exporter;
+    exporter.configure({{"capacity", 4}});
+    for (int n = 1; n <= 10; ++n) {
+        exporter.export_data(frame("L1", n));
+    }
+    CHECK_EQ(exporter.size(), 4u);
+
+    auto entries = exporter.latest("L1", 10);
+    CHECK_EQ(entries.size(), 4u);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        CHECK_EQ(entries[i].cursor, 7 + i);
+        CHECK_EQ(entries[i].data.values.at("p0"), static_cast<double>(7 + i));
+        CHECK(entries[i].data.timestamp == at(static_cast<int64_t>(7 + i)));
+    }
+
+    auto last = exporter.latest("L1", 1);
+    CHECK_EQ(last.size(), 1u);
+    CHECK_EQ(last[0].cursor, 10u);
+}
+
+// Lecteur incrémental: trames écrasées comptées, reprise au curseur rendu
+void testReadSinceOverwrite() {
+    InMemoryExporter exporter;
+    exporter.configure({{"capacity", 4}});
+    for (int n = 1; n <= 3; ++n) {
+        exporter.export_data(frame("L1", n));
+    }
+    auto first = exporter.read_since("L1", 0);
+    CHECK_EQ(first.entries.size(), 3u);
+    CHECK_EQ(first.missed, 0u);
+    CHECK_EQ(first.next_cursor, 3u);
+
+    // 6 trames de plus: 4 et 5 sont écrasées avant d'être lues
+    for (int n = 4; n <= 9; ++n) {
+        exporter.export_data(frame("L1", n));
+    }
+    auto second = exporter.read_since("L1", first.next_cursor);
+    CHECK_EQ(second.missed, 2u);
+    CHECK_EQ(second.entries.size(), 4u);
+    CHECK_EQ(second.entries.front().cursor, 6u);
+    CHECK_EQ(second.next_cursor, 9u);
+
+    // Lecture bornée, puis rien de nouveau
+    auto limited = exporter.read_since("L1", 5, 2);
+    CHECK_EQ(limited.entries.size(), 2u);
+    CHECK_EQ(limited.next_cursor, 7u);
+    auto empty = exporter.read_since("L1", second.next_cursor);
+    CHECK(empty.entries.empty());
+    CHECK_EQ(empty.next_cursor, 9u);
+}
+
+void testRangeAndFlush() {
+    InMemoryExporter exporter;
+    exporter.configure({{"capacity", 8}});
+    for (int n = 1; n <= 12; ++n) {
+        exporter.export_data(frame("L1", n));
+        exporter.export_data(frame("L2", 100 + n));
+    }
+    auto range = exporter.range("L1", at(6), at(9));
+    CHECK_EQ(range.size(), 4u);
+    CHECK_EQ(range.front().cursor, 6u);
+    CHECK_EQ(range.back().cursor, 9u);
+    // Début de plage déjà écrasé: seules les trames conservées sont rendues
+    CHECK_EQ(exporter.range("L1", at(0), at(100)).size(), 8u);
+
+    // flush() ne rend chaque trame qu'une fois, sans toucher aux autres lecteurs
+    CHECK_EQ(exporter.flush().size(), 16u);
+    CHECK(exporter.flush().empty());
+    exporter.export_data(frame("L1", 13));
+    auto flushed = exporter.flush();
+    CHECK_EQ(flushed.size(), 1u);
+    CHECK_EQ(exporter.latest("L1", 100).size(), 8u);
+    CHECK_EQ(exporter.collectors().size(), 2u);
+}
+
+// Jeu de points modifié: chaque case garde le schéma de sa trame, même après un tour
+void testSchemaChangeAndTruncation() {
+    InMemoryExporter exporter;
+    exporter.configure({{"capacity", 3}, {"max_points", 2}});
+    exporter.export_data(frame("L1", 1, 1));
+    exporter.export_data(frame("L1", 2, 2));
+    exporter.export_data(frame("L1", 3, 5)); // Tronquée à max_points
+    exporter.export_data(frame("L1", 4, 1));
+
+    auto entries = exporter.latest("L1", 3);
+    CHECK_EQ(entries.size(), 3u);
+    CHECK_EQ(entries[0].data.values.size(), 2u);
+    CHECK_EQ(entries[1].data.values.size(), 2u);
+    CHECK_EQ(entries[1].data.values.count("p2"), 0u);
+    CHECK_EQ(entries[2].data.values.size(), 1u);
+    CHECK_EQ(entries[2].data.values.at("p0"), 4.0);
+}
+
+// Jeu de points différent à chaque trame: les schémas des trames écrasées sont recyclés
+void testSchemaRecycling() {
+    InMemoryExporter exporter;
+    exporter.configure({{"capacity", 4}});
+    for (int n = 1; n <= 500; ++n) {
+        TelemetryData data("L1", {{"point" + std::to_string(n), n}});
+        data.timestamp = at(n);
+        exporter.export_data(data);
+    }
+    auto entries = exporter.latest("L1", 4);
+    CHECK_EQ(entries.size(), 4u);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        std::string name = "point" + std::to_string(497 + i);
+        CHECK_EQ(entries[i].data.values.count(name), 1u);
+        CHECK_EQ(entries[i].data.values.size(), 1u);
+    }
+
+    // Deux jeux de points en alternance réutilisent leurs schémas
+    for (int n = 501; n <= 1000; ++n) {
+        exporter.export_data(frame("L1", n, 1 + n % 2));
+    }
+    entries = exporter.latest("L1", 2);
+    CHECK_EQ(entries.size(), 2u);
+    CHECK_EQ(entries[0].data.values.size(), 2u);
+    CHECK_EQ(entries[1].data.values.size(), 1u);
+    CHECK_EQ(entries[1].data.values.at("p0"), 1000.0);
+}
+
+// Plus de jeux de points distincts dans l'anneau que de schémas: les plus anciens sont évincés
+void testSchemaEviction() {
+    InMemoryExporter exporter;
+    exporter.configure({{"capacity", 100}});
+    for (int n = 1; n <= 70; ++n) {
+        exporter.export_data(TelemetryData("L1", {{"point" + std::to_string(n), n}}));
+    }
+    CHECK_EQ(exporter.size(), 70u);
+    auto entries = exporter.latest("L1", 100);
+    CHECK_EQ(entries.size(), 64u);
+    CHECK_EQ(entries.front().cursor, 7u);
+    CHECK_EQ(entries.front().data.values.count("point7"), 1u);
+    auto missed = exporter.read_since("L1", 0);
+    CHECK_EQ(missed.missed, 6u);
+
+    // Les trames suivantes sont conservées normalement
+    exporter.export_data(frame("L1", 71));
+    auto last = exporter.latest("L1", 1);
+    CHECK_EQ(last.size(), 1u);
+    CHECK_EQ(last[0].data.values.at("p1"), 71.0);
+}
+
+// Seqlock: un lecteur concurrent ne voit jamais une trame à moitié réécrite
+void testConcurrentReader() {
+    InMemoryExporter exporter;
+    exporter.configure({{"capacity", 4}, {"max_points", 16}});
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<uint64_t> read{0};
+
+    std::thread reader([&] {
+        uint64_t cursor = 0;
+        while (!done.load()) {
+            auto result = exporter.read_since("L1", cursor);
+            for (const auto& entry : result.entries) {
+                for (const auto& pair : entry.data.values) {
+                    if (pair.second != static_cast<double>(entry.cursor)) torn++;
+                }
+                if (entry.data.timestamp != at(static_cast<int64_t>(entry.cursor))) torn++;
+            }
+            read += result.entries.size();
+            cursor = result.next_cursor;
+        }
+    });
+
+    for (int n = 1; n <= 200000; ++n) {
+        exporter.export_data(frame("L1", n, 16));
+    }
+    done = true;
+    reader.join();
+    CHECK_EQ(torn.load(), 0);
+    CHECK(read.load() > 0);
+}
+
+} // namespace
+
+int main() {
+    testWraparound();
+    testReadSinceOverwrite();
+    testRangeAndFlush();
+    testSchemaChangeAndTruncation();
+    testSchemaRecycling();
+    testSchemaEviction();
+    testConcurrentReader();
+    return TEST_RESULT();
+}
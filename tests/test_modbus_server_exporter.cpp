@@ -0,0 +1,133 @@
+#include "exporters/modbus_server_exporter.h"
+#include "test_helpers.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using namespace modbustt;
+using namespace modbustt::exporters;
+
+namespace {
+
+constexpr int kPort = 15502;
+
+/**
+ * Client TCP brut: connecté au serveur de test, lectures limitées à 500 ms
+ */
+int connectClient() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    timeval timeout{0, 500000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+// Requête FC 03 d'un registre à l'adresse donnée
+std::vector<uint8_t> readHoldingRequest(uint16_t transaction, uint16_t address) {
+    return {static_cast<uint8_t>(transaction >> 8), static_cast<uint8_t>(transaction & 0xFF),
+            0x00, 0x00, 0x00, 0x06, 0x01, 0x03,
+            static_cast<uint8_t>(address >> 8), static_cast<uint8_t>(address & 0xFF), 0x00, 0x01};
+}
+
+bool sendBytes(int fd, const std::vector<uint8_t>& bytes, size_t begin, size_t end) {
+    return send(fd, bytes.data() + begin, end - begin, 0) == static_cast<ssize_t>(end - begin);
+}
+
+/**
+ * Lit une réponse FC 03 d'un registre (11 octets); -1 si rien n'arrive à temps
+ */
+int readRegisterReply(int fd, uint16_t transaction) {
+    uint8_t reply[11];
+    size_t received = 0;
+    while (received < sizeof(reply)) {
+        ssize_t rc = recv(fd, reply + received, sizeof(reply) - received, 0);
+        if (rc <= 0) return -1;
+        received += static_cast<size_t>(rc);
+    }
+    if (((reply[0] << 8) | reply[1]) != transaction || reply[7] != 0x03 || reply[8] != 2) return -1;
+    return (reply[9] << 8) | reply[10];
+}
+
+// Un client qui n'envoie qu'une partie de sa requête ne retarde pas les autres
+void testSlowClientDoesNotStallOthers() {
+    ModbusServerExporter exporter;
+    exporter.configure({{"listen", "127.0.0.1"}, {"port", kPort},
+                        {"holding_registers", 10}, {"input_registers", 10},
+                        {"mappings", {{{"collector_id", "L1"}, {"point", "temperature"}, {"address", 2}}}}});
+    CHECK(exporter.connect());
+    if (!exporter.is_connected()) return;
+
+    TelemetryData data("L1", {{"temperature", 421.0}});
+    exporter.export_data(data);
+
+    int slow = connectClient();
+    int fast = connectClient();
+    CHECK(slow >= 0);
+    CHECK(fast >= 0);
+    if (slow < 0 || fast < 0) return;
+
+    // En-tête MBAP seul: le serveur doit garder ces octets en attente
+    std::vector<uint8_t> slow_request = readHoldingRequest(1, 2);
+    CHECK(sendBytes(slow, slow_request, 0, 7));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> fast_request = readHoldingRequest(2, 2);
+    CHECK(sendBytes(fast, fast_request, 0, fast_request.size()));
+    CHECK_EQ(readRegisterReply(fast, 2), 421);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(400));
+
+    // Fin de la requête lente, puis deux requêtes enchaînées dans le même envoi
+    CHECK(sendBytes(slow, slow_request, 7, slow_request.size()));
+    CHECK_EQ(readRegisterReply(slow, 1), 421);
+    std::vector<uint8_t> pipelined = readHoldingRequest(3, 2);
+    std::vector<uint8_t> second = readHoldingRequest(4, 3);
+    pipelined.insert(pipelined.end(), second.begin(), second.end());
+    CHECK(sendBytes(slow, pipelined, 0, pipelined.size()));
+    CHECK_EQ(readRegisterReply(slow, 3), 421);
+    CHECK_EQ(readRegisterReply(slow, 4), 0);
+    CHECK_EQ(exporter.requests_served(), 4u);
+
+    close(slow);
+    close(fast);
+    exporter.disconnect();
+}
+
+// Un en-tête MBAP invalide ferme la connexion du client
+void testInvalidHeaderClosesClient() {
+    ModbusServerExporter exporter;
+    exporter.configure({{"listen", "127.0.0.1"}, {"port", kPort}});
+    CHECK(exporter.connect());
+    if (!exporter.is_connected()) return;
+
+    int fd = connectClient();
+    CHECK(fd >= 0);
+    if (fd < 0) return;
+    std::vector<uint8_t> request = readHoldingRequest(1, 0);
+    request[5] = 0xFF; // Longueur au-delà d'une ADU Modbus TCP
+    CHECK(sendBytes(fd, request, 0, request.size()));
+    uint8_t byte;
+    CHECK_EQ(recv(fd, &byte, 1, 0), 0);
+
+    close(fd);
+    exporter.disconnect();
+}
+
+} // namespace
+
+int main() {
+    testSlowClientDoesNotStallOthers();
+    testInvalidHeaderClosesClient();
+    return TEST_RESULT();
+}
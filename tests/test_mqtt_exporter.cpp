@@ -0,0 +1,56 @@
+#include "exporters/mqtt_exporter.h"
+#include "test_helpers.h"
+
+using namespace modbustt::exporters;
+
+namespace {
+
+nlohmann::json makeConfig(const std::string& indicator) {
+    return {{"broker_address", "tcp://localhost"}, {"encoding", "cbor"}, {"content_type_indicator", indicator}};
+}
+
+// Mode propriété: client et connexion en MQTT v5, clean_start sans clean_session
+void testPropertyMode() {
+    MqttExporter exporter;
+    exporter.configure(makeConfig("property"));
+    const mqtt::connect_options& options = exporter.get_connect_options();
+    CHECK_EQ(exporter.get_mqtt_version(), MQTTVERSION_5);
+    CHECK_EQ(options.get_mqtt_version(), MQTTVERSION_5);
+    CHECK(options.is_clean_start());
+    CHECK(!options.is_clean_session());
+}
+
+// Suffixe de topic: version par défaut, clean_session sans clean_start
+void testTopicSuffixMode() {
+    MqttExporter exporter;
+    exporter.configure(makeConfig("topic_suffix"));
+    const mqtt::connect_options& options = exporter.get_connect_options();
+    CHECK_EQ(exporter.get_mqtt_version(), MQTTVERSION_DEFAULT);
+    CHECK_EQ(options.get_mqtt_version(), MQTTVERSION_DEFAULT);
+    CHECK(options.is_clean_session());
+    CHECK(!options.is_clean_start());
+}
+
+// Reconfiguration: les indicateurs du mode précédent ne sont pas conservés
+void testReconfigure() {
+    MqttExporter exporter;
+    exporter.configure(makeConfig("property"));
+    exporter.configure(makeConfig("none"));
+    CHECK_EQ(exporter.get_mqtt_version(), MQTTVERSION_DEFAULT);
+    CHECK(exporter.get_connect_options().is_clean_session());
+    CHECK(!exporter.get_connect_options().is_clean_start());
+
+    exporter.configure(makeConfig("property"));
+    CHECK_EQ(exporter.get_connect_options().get_mqtt_version(), MQTTVERSION_5);
+    CHECK(exporter.get_connect_options().is_clean_start());
+    CHECK(!exporter.get_connect_options().is_clean_session());
+}
+
+} // namespace
+
+int main() {
+    testPropertyMode();
+    testTopicSuffixMode();
+    testReconfigure();
+    return TEST_RESULT();
+}
@@ -0,0 +1,212 @@
+#include "exporters/payload_encoding.h"
+#include "test_helpers.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace modbustt;
+using namespace modbustt::exporters;
+
+namespace {
+
+/**
+ * Trame construite par nlohmann::json, référence de write_frame_json
+ */
+std::string referenceJson(const TelemetryData& data) {
+    nlohmann::json frame;
+    frame["collector_id"] = data.collector_id;
+    frame["timestamp"] = format_timestamp_utc(data.timestamp);
+    frame["values"] = data.values;
+    return frame.dump();
+}
+
+TelemetryData makeFrame(const std::string& id, std::initializer_list<double> values) {
+    TelemetryData data(id, {});
+    data.timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    int index = 0;
+    for (double value : values) {
+        data.values["p" + std::to_string(index++)] = value;
+    }
+    return data;
+}
+
+// Valeurs limites de la notation: entiers, exposants -5 et 15, sous-normaux
+void testJsonSpecialValues() {
+    const double values[] = {
+        0.0, -0.0, 1.0, 25.0, 25.5, 100.0, 0.1, 1.0 / 3, 1e-4, 1e-5, 0.0001234, 12345.678,
+        1e15, 1e16, 1e21, 123456789012345.0, -2.5e-300, 5e-324,
+        std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+    };
+    for (double value : values) {
+        TelemetryData data = makeFrame("L1", {value});
+        std::string out;
+        write_frame_json(data, out);
+        CHECK_EQ(out, referenceJson(data));
+    }
+
+    // Valeurs non finies: null, comme dump()
+    TelemetryData data = makeFrame("L1", {std::nan(""), std::numeric_limits<double>::infinity()});
+    std::string out;
+    write_frame_json(data, out);
+    CHECK_EQ(out, referenceJson(data));
+}
+
+// Identifiants à échapper: guillemets, contrôles, UTF-8
+void testJsonStringEscaping() {
+    TelemetryData data = makeFrame("li\"ne\\\n\t\x01\xc3\xa9", {1.5});
+    data.values["p\"/"] = 2.0;
+    std::string out;
+    write_frame_json(data, out);
+    CHECK_EQ(out, referenceJson(data));
+}
+
+// Nombre seul tel qu'écrit dans une trame
+std::string jsonNumber(double value) {
+    TelemetryData data = makeFrame("L1", {value});
+    std::string out;
+    write_frame_json(data, out);
+    size_t start = out.find("\"p0\":") + 5;
+    return out.substr(start, out.find('}', start) - start);
+}
+
+// Format attendu des nombres, indépendamment de la bibliothèque de conversion
+void testJsonNumberFormat() {
+    CHECK_EQ(jsonNumber(25.0), std::string("25.0"));
+    CHECK_EQ(jsonNumber(-0.0), std::string("-0.0"));
+    CHECK_EQ(jsonNumber(25.5), std::string("25.5"));
+    CHECK_EQ(jsonNumber(0.1), std::string("0.1"));
+    CHECK_EQ(jsonNumber(1.0 / 3), std::string("0.3333333333333333"));
+    CHECK_EQ(jsonNumber(0.0001), std::string("0.0001"));
+    CHECK_EQ(jsonNumber(0.0001234), std::string("0.0001234"));
+    CHECK_EQ(jsonNumber(1e-5), std::string("1e-05"));
+    CHECK_EQ(jsonNumber(-2.5e-300), std::string("-2.5e-300"));
+    CHECK_EQ(jsonNumber(5e-324), std::string("5e-324"));
+    CHECK_EQ(jsonNumber(123456789012345.0), std::string("123456789012345.0"));
+    CHECK_EQ(jsonNumber(1e14), std::string("100000000000000.0"));
+    CHECK_EQ(jsonNumber(1e15), std::string("1e+15"));
+    CHECK_EQ(jsonNumber(1e16), std::string("1e+16"));
+    CHECK_EQ(jsonNumber(1.5e300), std::string("1.5e+300"));
+    CHECK_EQ(jsonNumber(std::numeric_limits<double>::max()), std::string("1.7976931348623157e+308"));
+}
+
+// Motifs binaires aléatoires, toutes les plages d'exposant: relecture exacte,
+// notation de dump() et jamais plus de chiffres que lui
+void testJsonRandomRoundTrip() {
+    std::mt19937_64 rng(42);
+    for (int iteration = 0; iteration < 100000; ++iteration) {
+        double value;
+        if (iteration % 2) {
+            uint64_t bits = rng();
+            std::memcpy(&value, &bits, sizeof(value));
+        } else {
+            value = static_cast<double>(static_cast<int64_t>(rng() % 100000)) / static_cast<double>(1 + rng() % 1000);
+        }
+        if (!std::isfinite(value)) continue;
+
+        std::string out = jsonNumber(value);
+        std::string reference = nlohmann::json(value).dump();
+        CHECK(std::strtod(out.c_str(), nullptr) == value);
+        CHECK_EQ(out.find('e') == std::string::npos, reference.find('e') == std::string::npos);
+        CHECK(out.size() <= reference.size());
+    }
+}
+
+// Le cache de la trame rend les mêmes octets que la sérialisation directe
+void testEncodedFrameCache() {
+    TelemetryData data = makeFrame("L1", {20.5, -3.25});
+    std::string direct;
+    write_frame_json(data, direct);
+    CHECK_EQ(encoded_frame(data, PayloadEncoding::JSON), direct);
+    CHECK(&encoded_frame(data, PayloadEncoding::JSON) == &encoded_frame(data, PayloadEncoding::JSON));
+
+    // Écriture hors cache: ajoutée à la fin du tampon de l'appelant
+    std::string appended = "x";
+    write_frame(data, PayloadEncoding::CBOR, appended);
+    CHECK_EQ(appended, "x" + encoded_frame(data, PayloadEncoding::CBOR));
+}
+
+std::vector<uint8_t> bytesOf(const std::string& text) {
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+// Trames binaires: mêmes octets que nlohmann::json, relues à l'identique
+void testBinaryFrames() {
+    TelemetryData data = makeFrame("L1", {20.5, -3.25, 1e300, 0.0});
+    nlohmann::json reference = nlohmann::json::parse(referenceJson(data));
+
+    const std::string& cbor = encoded_frame(data, PayloadEncoding::CBOR);
+    CHECK(bytesOf(cbor) == nlohmann::json::to_cbor(reference));
+    CHECK(nlohmann::json::from_cbor(cbor) == reference);
+
+    const std::string& msgpack = encoded_frame(data, PayloadEncoding::MSGPACK);
+    CHECK(bytesOf(msgpack) == nlohmann::json::to_msgpack(reference));
+    CHECK(nlohmann::json::from_msgpack(msgpack) == reference);
+
+    // Un cache par encodage, tous conservés
+    CHECK_EQ(encoded_frame(data, PayloadEncoding::JSON), referenceJson(data));
+    CHECK(bytesOf(encoded_frame(data, PayloadEncoding::CBOR)) == nlohmann::json::to_cbor(reference));
+}
+
+// Lots concaténés: chaque taille de l'en-tête de tableau (1, 2, 3 et 5 octets)
+void testBatchArrays() {
+    const size_t counts[] = {0, 1, 15, 16, 23, 24, 255, 256, 65535, 65536};
+    const PayloadEncoding encodings[] = {PayloadEncoding::JSON, PayloadEncoding::CBOR, PayloadEncoding::MSGPACK};
+    TelemetryData data = makeFrame("L1", {1.5});
+    nlohmann::json element = nlohmann::json::parse(referenceJson(data));
+
+    for (PayloadEncoding encoding : encodings) {
+        const std::string& frame = encoded_frame(data, encoding);
+        for (size_t count : counts) {
+            std::string batch = array_prefix(encoding, count);
+            for (size_t i = 0; i < count; ++i) {
+                if (i > 0) batch += array_separator(encoding);
+                batch += frame;
+            }
+            batch += array_suffix(encoding);
+
+            nlohmann::json expected = nlohmann::json::array();
+            for (size_t i = 0; i < count; ++i) {
+                expected.push_back(element);
+            }
+            switch (encoding) {
+                case PayloadEncoding::CBOR:
+                    CHECK(bytesOf(batch) == nlohmann::json::to_cbor(expected));
+                    break;
+                case PayloadEncoding::MSGPACK:
+                    CHECK(bytesOf(batch) == nlohmann::json::to_msgpack(expected));
+                    break;
+                case PayloadEncoding::JSON:
+                    CHECK_EQ(batch, expected.dump());
+                    break;
+            }
+        }
+    }
+}
+
+void testEncodingNames() {
+    CHECK(parse_encoding("json") == PayloadEncoding::JSON);
+    CHECK(parse_encoding("cbor") == PayloadEncoding::CBOR);
+    CHECK(parse_encoding("msgpack") == PayloadEncoding::MSGPACK);
+    CHECK(parse_encoding("xml") == PayloadEncoding::JSON);
+    CHECK_EQ(std::string(content_type(PayloadEncoding::CBOR)), "application/cbor");
+
+    std::string prefix;
+    append_length_prefix(prefix, 0x01020304);
+    CHECK_EQ(prefix, std::string("\x01\x02\x03\x04"));
+}
+
+} // namespace
+
+int main() {
+    testJsonSpecialValues();
+    testJsonStringEscaping();
+    testJsonNumberFormat();
+    testJsonRandomRoundTrip();
+    testEncodedFrameCache();
+    testBinaryFrames();
+    testBatchArrays();
+    testEncodingNames();
+    return TEST_RESULT();
+}
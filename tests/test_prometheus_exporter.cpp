@@ -0,0 +1,76 @@
+#include "exporters/prometheus_exporter.h"
+#include "test_helpers.h"
+#include <memory>
+#include <string>
+
+using namespace modbustt;
+using namespace modbustt::exporters;
+
+namespace {
+
+bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+// Ligne d'une série: valeur alignée à droite sur 24 caractères
+std::string seriesLine(const std::string& collector_id, const std::string& point, const std::string& value) {
+    return "modbus_point_value{collector_id=\"" + collector_id + "\",point=\"" + point + "\"} " +
+           std::string(24 - value.size(), ' ') + value + "\n";
+}
+
+// Source liée à la durée de vie d'un objet, comme les collecteurs dans main.cpp
+PrometheusExporter::StatsSource sourceFor(const std::shared_ptr<int>& owner) {
+    std::weak_ptr<int> weak = owner;
+    return [weak](CollectorStats& stats) {
+        if (!weak.lock()) return false;
+        stats = CollectorStats();
+        return true;
+    };
+}
+
+// Valeurs réécrites sur place: seule la dernière est exposée
+void testValuesUpdatedInPlace() {
+    PrometheusExporter exporter;
+    exporter.configure(nlohmann::json::object());
+    exporter.export_data(TelemetryData("L1", {{"temperature", 20.5}}));
+    exporter.export_data(TelemetryData("L1", {{"temperature", 21.0}, {"pressure", 3}}));
+
+    std::string text = exporter.render();
+    CHECK(contains(text, seriesLine("L1", "temperature", "21")));
+    CHECK(contains(text, seriesLine("L1", "pressure", "3")));
+    CHECK(!contains(text, "20.5"));
+}
+
+// Collecteur arrêté: ses séries disparaissent, les autres gardent leur valeur et restent à jour
+void testStoppedCollectorRemoved() {
+    PrometheusExporter exporter;
+    exporter.configure(nlohmann::json::object());
+    auto first = std::make_shared<int>(1);
+    auto second = std::make_shared<int>(2);
+    exporter.add_stats_source("L1", sourceFor(first));
+    exporter.add_stats_source("L2", sourceFor(second));
+    exporter.export_data(TelemetryData("L1", {{"temperature", 1.5}, {"pressure", 2.5}}));
+    exporter.export_data(TelemetryData("L2", {{"temperature", 3.5}}));
+
+    std::string text = exporter.render();
+    CHECK(contains(text, "collector_id=\"L1\",point=\"pressure\""));
+    CHECK(contains(text, "modbus_collector_scans_total{collector_id=\"L1\"}"));
+
+    first.reset();
+    text = exporter.render();
+    CHECK(!contains(text, "collector_id=\"L1\""));
+    CHECK(contains(text, seriesLine("L2", "temperature", "3.5")));
+
+    exporter.export_data(TelemetryData("L2", {{"temperature", 4.25}}));
+    text = exporter.render();
+    CHECK(contains(text, seriesLine("L2", "temperature", "4.25")));
+    CHECK(contains(text, "# TYPE modbus_point_value gauge\n"));
+}
+
+} // namespace
+
+int main() {
+    testValuesUpdatedInPlace();
+    testStoppedCollectorRemoved();
+    return TEST_RESULT();
+}
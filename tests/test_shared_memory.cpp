@@ -0,0 +1,105 @@
+#include "exporters/shared_memory_exporter.h"
+#include "shm_reader.h"
+#include "test_helpers.h"
+#include <unistd.h>
+
+using namespace modbustt;
+using namespace modbustt::exporters;
+
+namespace {
+
+// Région propre au processus: les tests parallèles ne se marchent pas dessus
+std::string regionName() {
+    return "/modbustt_test_" + std::to_string(getpid());
+}
+
+TelemetryData frame(const std::string& id, int n) {
+    TelemetryData data(id, {});
+    data.timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(n));
+    data.values["a"] = n;
+    data.values["b"] = -n;
+    return data;
+}
+
+// Anneau de 4 cases: les trames écrasées sont comptées, la reprise suit le curseur
+void testRingWraparound() {
+    SharedMemoryExporter exporter;
+    exporter.configure({{"name", regionName()}, {"ring_slots", 4}});
+    CHECK(exporter.connect());
+
+    SharedMemoryReader reader;
+    CHECK(reader.open(regionName()));
+    CHECK_EQ(reader.head(), 0u);
+
+    for (int n = 1; n <= 3; ++n) {
+        exporter.export_data(frame("L1", n));
+    }
+    auto first = reader.read_since(0);
+    CHECK_EQ(first.frames.size(), 3u);
+    CHECK_EQ(first.missed, 0u);
+    CHECK_EQ(first.next_cursor, 3u);
+
+    for (int n = 4; n <= 10; ++n) {
+        exporter.export_data(frame("L1", n));
+    }
+    CHECK_EQ(reader.head(), 10u);
+    auto second = reader.read_since(first.next_cursor);
+    CHECK_EQ(second.missed, 3u);
+    CHECK_EQ(second.frames.size(), 4u);
+    CHECK_EQ(second.next_cursor, 10u);
+    for (size_t i = 0; i < second.frames.size(); ++i) {
+        const TelemetryData& data = second.frames[i];
+        CHECK_EQ(data.collector_id, std::string("L1"));
+        CHECK_EQ(data.values.at("a"), static_cast<double>(7 + i));
+        CHECK_EQ(data.values.at("b"), -static_cast<double>(7 + i));
+    }
+
+    // Premier appel après un tour: les plus anciennes conservées, sans trame manquée
+    auto fresh = reader.read_since(0, 2);
+    CHECK_EQ(fresh.missed, 0u);
+    CHECK_EQ(fresh.frames.size(), 2u);
+    CHECK_EQ(fresh.frames.front().values.at("a"), 7.0);
+
+    exporter.disconnect();
+    CHECK(reader.writer_closed());
+}
+
+// Table des dernières valeurs: un handle par point, mis à jour sur place
+void testLatestValues() {
+    SharedMemoryExporter exporter;
+    exporter.configure({{"name", regionName()}, {"ring_slots", 2}});
+    CHECK(exporter.connect());
+    SharedMemoryReader reader;
+    CHECK(reader.open(regionName()));
+
+    CHECK_EQ(reader.find("L1", "a"), -1);
+    exporter.export_data(frame("L1", 1));
+    exporter.export_data(frame("L2", 50));
+    int handle = reader.find("L1", "a");
+    CHECK(handle >= 0);
+
+    for (int n = 2; n <= 20; ++n) {
+        exporter.export_data(frame("L1", n));
+    }
+    double value = 0.0;
+    int64_t timestampNs = 0;
+    CHECK(reader.read(handle, value, &timestampNs));
+    CHECK_EQ(value, 20.0);
+    CHECK_EQ(timestampNs, int64_t(20) * 1000000000);
+    CHECK(!reader.read(-1, value));
+
+    auto snapshot = reader.snapshot();
+    CHECK_EQ(snapshot.size(), 2u);
+    for (const auto& data : snapshot) {
+        CHECK_EQ(data.values.at("a"), data.collector_id == "L1" ? 20.0 : 50.0);
+    }
+    exporter.disconnect();
+}
+
+} // namespace
+
+int main() {
+    testRingWraparound();
+    testLatestValues();
+    return TEST_RESULT();
+}
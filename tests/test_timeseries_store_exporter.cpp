@@ -0,0 +1,96 @@
+#include "exporters/timeseries_store_exporter.h"
+#include "test_helpers.h"
+#include <filesystem>
+#include <thread>
+#include <unistd.h>
+
+using namespace modbustt;
+using namespace modbustt::exporters;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Répertoire de stockage propre au test
+std::string storePath(const std::string& name) {
+    std::string path = (fs::temp_directory_path() / ("modbustt_tsdb_" + name + "_" + std::to_string(getpid()))).string();
+    fs::remove_all(path);
+    return path;
+}
+
+TelemetryData frame(const std::string& id, int64_t timestamp_ms, double value) {
+    TelemetryData data(id, {{"temperature", value}, {"pressure", value * 2}, {"flow", value * 3}});
+    data.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(timestamp_ms));
+    return data;
+}
+
+// Blocs scellés ensemble sur deux partitions: relus après réouverture, dans l'ordre
+void testBatchedSealAcrossPartitions() {
+    std::string path = storePath("batch");
+    const int64_t start = (int64_t(1700000000) / 3600) * 3600 * 1000 + 3500 * 1000;
+    {
+        TimeSeriesStoreExporter store;
+        store.configure({{"path", path}, {"chunk_points", 10}, {"retention_hours", 0}, {"max_chunk_age_s", 0}});
+        CHECK(store.connect());
+        for (int i = 0; i < 250; ++i) {
+            store.export_data(frame("L1", start + i * 1000, i));
+        }
+        store.disconnect();
+    }
+    size_t partitions = 0;
+    for (const auto& entry : fs::directory_iterator(path)) {
+        if (entry.path().extension() == ".tsdb") partitions++;
+    }
+    CHECK_EQ(partitions, 2u);
+
+    TimeSeriesStoreExporter store;
+    store.configure({{"path", path}, {"retention_hours", 0}, {"max_chunk_age_s", 0}});
+    CHECK(store.connect());
+    CHECK_EQ(store.list_series().size(), 3u);
+    auto points = store.query("L1", "pressure", start, start + 250 * 1000);
+    CHECK_EQ(points.size(), 250u);
+    for (size_t i = 0; i < points.size(); ++i) {
+        CHECK_EQ(points[i].timestamp_ms, start + static_cast<int64_t>(i) * 1000);
+        CHECK_EQ(points[i].value, 2.0 * static_cast<double>(i));
+    }
+    store.disconnect();
+    fs::remove_all(path);
+}
+
+// Série lente: le bloc incomplet est écrit sur disque après max_chunk_age_s
+void testTimedSeal() {
+    std::string path = storePath("age");
+    TimeSeriesStoreExporter store;
+    store.configure({{"path", path}, {"chunk_points", 120}, {"retention_hours", 0}, {"max_chunk_age_s", 1}});
+    CHECK(store.connect());
+    store.export_data(frame("L1", 1700000000000, 1.0));
+    store.export_data(frame("L1", 1700000001000, 2.0));
+
+    auto partitionBytes = [&] {
+        uintmax_t bytes = 0;
+        for (const auto& entry : fs::directory_iterator(path)) {
+            if (entry.path().extension() == ".tsdb") bytes += fs::file_size(entry.path());
+        }
+        return bytes;
+    };
+    CHECK_EQ(partitionBytes(), 0u);
+    for (int attempt = 0; attempt < 40 && partitionBytes() == 0; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    CHECK(partitionBytes() > 0);
+
+    // Points toujours lisibles, le bloc suivant repart de zéro
+    CHECK_EQ(store.query("L1", "flow", 0, 1800000000000).size(), 2u);
+    store.export_data(frame("L1", 1700000002000, 3.0));
+    CHECK_EQ(store.query("L1", "flow", 0, 1800000000000).size(), 3u);
+    store.disconnect();
+    fs::remove_all(path);
+}
+
+} // namespace
+
+int main() {
+    testBatchedSealAcrossPartitions();
+    testTimedSeal();
+    return TEST_RESULT();
+}
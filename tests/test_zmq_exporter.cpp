@@ -0,0 +1,101 @@
+#include "exporters/zmq_exporter.h"
+#include "test_helpers.h"
+#include <zmq.h>
+#include <chrono>
+#include <string>
+
+using namespace modbustt;
+using namespace modbustt::exporters;
+
+namespace {
+
+TelemetryData makeFrame(const std::string& id, double value) {
+    TelemetryData data(id, {{"temperature", value}});
+    data.timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    return data;
+}
+
+/**
+ * Reçoit une partie de message; false si rien n'arrive avant le délai du socket
+ */
+bool receivePart(void* socket, std::string& part, bool& more) {
+    zmq_msg_t message;
+    zmq_msg_init(&message);
+    if (zmq_msg_recv(&message, socket, 0) < 0) {
+        zmq_msg_close(&message);
+        return false;
+    }
+    part.assign(static_cast<const char*>(zmq_msg_data(&message)), zmq_msg_size(&message));
+    more = zmq_msg_more(&message) != 0;
+    zmq_msg_close(&message);
+    return true;
+}
+
+// Abonné inproc dans le contexte de l'exporter: topic et payload en deux parties
+void testInprocRoundTrip(PayloadEncoding encoding, const char* name) {
+    ZmqExporter exporter;
+    std::string endpoint = std::string("inproc://modbustt_test_") + name;
+    exporter.configure({{"endpoint", endpoint}, {"bind", true}, {"topic_prefix", "site/"}, {"encoding", name}});
+    CHECK(exporter.connect());
+    if (!exporter.is_connected()) return;
+
+    void* subscriber = zmq_socket(exporter.zmq_context(), ZMQ_SUB);
+    int timeout_ms = 100;
+    zmq_setsockopt(subscriber, ZMQ_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    zmq_setsockopt(subscriber, ZMQ_SUBSCRIBE, "site/L1", 7);
+    CHECK_EQ(zmq_connect(subscriber, endpoint.c_str()), 0);
+
+    // L'abonnement est propagé de façon asynchrone: sonder jusqu'au premier message reçu
+    std::string topic;
+    std::string payload;
+    bool more = false;
+    bool joined = false;
+    for (int attempt = 0; attempt < 50 && !joined; ++attempt) {
+        TelemetryData probe = makeFrame("L1", -1.0);
+        exporter.export_data(probe);
+        joined = receivePart(subscriber, topic, more);
+    }
+    CHECK(joined);
+    if (joined) {
+        CHECK(more);
+        CHECK(receivePart(subscriber, payload, more));
+        CHECK(!more);
+    }
+    // Sondes restantes en file
+    while (receivePart(subscriber, topic, more)) {
+    }
+
+    // Messages filtrés (L2) et messages reçus en paires dans l'ordre d'envoi
+    for (int i = 0; i < 100; ++i) {
+        TelemetryData other = makeFrame("L2", i);
+        exporter.export_data(other);
+        TelemetryData frame = makeFrame("L1", i);
+        exporter.export_data(frame);
+    }
+    int received = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (!receivePart(subscriber, topic, more)) break;
+        CHECK_EQ(topic, std::string("site/L1"));
+        CHECK(more);
+        if (!receivePart(subscriber, payload, more)) break;
+        CHECK(!more);
+        TelemetryData expected = makeFrame("L1", i);
+        CHECK(payload == encoded_frame(expected, encoding));
+        received++;
+    }
+    CHECK_EQ(received, 100);
+    CHECK(!receivePart(subscriber, topic, more));
+    CHECK_EQ(exporter.dropped_messages(), 0u);
+
+    zmq_close(subscriber);
+    exporter.disconnect();
+    CHECK(!exporter.is_connected());
+}
+
+} // namespace
+
+int main() {
+    testInprocRoundTrip(PayloadEncoding::JSON, "json");
+    testInprocRoundTrip(PayloadEncoding::CBOR, "cbor");
+    return TEST_RESULT();
+}